@@ -0,0 +1,537 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "game.h"
+#include "game_logic.h"
+#include "game_record.h"
+#include "line_tracker.h"
+#include "match_journal.h"
+#include "opening_book.h"
+#include "particle_renderer.h"
+#include "particle_system.h"
+#include "profiler.h"
+#include "search.h"
+#include "tablebase.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+#include "zobrist.h"
+
+using namespace std;
+
+// Microbenchmarks for the engine and frame hot paths. Results are printed to stdout
+// as JSON so runs of different builds can be compared; progress goes to stderr.
+//
+//   bench [--filter TEXT] [--min-time MS] [--replay RECORDING] [--threads N]
+//
+// --replay adds a "replay" benchmark that runs a recording made with tictactoe --record
+// headlessly, as fast as it will go, and checks it reproduces the recorded session.
+// --threads sets the threads of the parallel searches (default: every core); the "speedup"
+// section compares a fixed-depth parallel search with the single-threaded one.
+
+// Result of one benchmark
+struct BenchResult {
+    string name;
+    long long iterations = 0;
+    double totalMs = 0;
+    double nsPerOp = 0;
+    long long itemsPerOp = 1;   // particles per update, for a per-item figure
+};
+
+struct BenchOptions {
+    string filter;
+    double minTimeMs = 250;
+    string replayPath;
+    int threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+};
+
+// Parallel search speedup on one position
+struct SpeedupResult {
+    string name;
+    SpeedupReport report;
+};
+
+// Results are folded in here so the optimizer cannot drop the benchmarked work
+volatile long long benchSink = 0;
+
+// Function to make the optimizer assume the value changed, so loop-invariant checks are not hoisted
+template <class T>
+void clobber(T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    benchSink = benchSink + reinterpret_cast<volatile char&>(value);
+#endif
+}
+
+bool selected(const BenchOptions& options, const string& name) {
+    return options.filter.empty() || name.find(options.filter) != string::npos;
+}
+
+// Function to call fn in doubling batches until minTimeMs has passed (and at least minIterations calls)
+template <class Fn>
+void runBench(vector<BenchResult>& results, const BenchOptions& options, const string& name, Fn fn,
+              long long minIterations = 1, long long itemsPerOp = 1) {
+    if (!selected(options, name)) return;
+    cerr << "  " << name << endl;
+
+    BenchResult result;
+    result.name = name;
+    result.itemsPerOp = itemsPerOp;
+    long long batch = 1;
+    auto start = chrono::steady_clock::now();
+    for (;;) {
+        long long sink = 0;
+        for (long long i = 0; i < batch; i++) sink += fn();
+        benchSink = benchSink + sink;
+        result.iterations += batch;
+        result.totalMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (result.totalMs >= options.minTimeMs && result.iterations >= minIterations) break;
+        batch *= 2;
+    }
+    result.nsPerOp = result.totalMs * 1e6 / result.iterations;
+    results.push_back(result);
+}
+
+// Function to build a board from a string of 'X', 'O' and '.' in row-major order
+template <class BoardT>
+BoardT boardFrom(const string& cells) {
+    BoardT position;
+    for (int cell = 0; cell < BoardT::CELLS && cell < static_cast<int>(cells.size()); cell++) {
+        if (cells[cell] == 'X') position.place(cell, X_PLAYER);
+        else if (cells[cell] == 'O') position.place(cell, O_PLAYER);
+    }
+    return position;
+}
+
+// Function to benchmark the rule checks and the reference minimax
+void benchRules(vector<BenchResult>& results, const BenchOptions& options) {
+    const pair<const char*, const char*> positions[] = {
+        {"empty", "........."},
+        {"opening", "....X...O"},
+        {"midgame", "X.O.X..O."},
+        {"full", "XOXXOOOXX"}
+    };
+    for (const auto& [label, cells] : positions) {
+        Board position = boardFrom<Board>(cells);
+        runBench(results, options, string("checkWin/3x3/") + label, [&]() { clobber(position); return position.checkWin() ? 1 : 0; });
+        runBench(results, options, string("checkDraw/3x3/") + label, [&]() { clobber(position); return position.isFull() ? 1 : 0; });
+    }
+    // The same checks on the largest board, where the masks span several words
+    using BigBoard = BasicBoard<15, 5>;
+    BigBoard big = boardFrom<BigBoard>(string(7 * 15, '.') + ".....XOXOXO....");
+    runBench(results, options, "checkWin/15x15/midgame", [&]() { clobber(big); return big.checkWin() ? 1 : 0; });
+    runBench(results, options, "checkDraw/15x15/midgame", [&]() { clobber(big); return big.isFull() ? 1 : 0; });
+    // Incremental per-line counts: win and threat checks read them, make/unmake touch only the lines through a cell
+    LineTracker<15, 5> tracked(big);
+    runBench(results, options, "trackedWin/15x15/midgame", [&]() { clobber(tracked); return tracked.checkWin() ? 1 : 0; });
+    runBench(results, options, "completingCell/15x15/midgame", [&]() { clobber(tracked); return tracked.completingCell(O_PLAYER); });
+    int below = BigBoard::cellIndex(8, 7);
+    runBench(results, options, "makeUnmake/15x15/midgame", [&]() {
+        int won = tracked.make(below, O_PLAYER) ? 1 : 0;
+        tracked.unmake(below);
+        return won;
+    });
+
+    // Full-width minimax for the side to move (O maximises), as the original Hard level ran it
+    for (const auto& [label, cells] : positions) {
+        if (string(label) == "full") continue;
+        Board position = boardFrom<Board>(cells);
+        bool oToMove = position.sideToMove() == O_PLAYER;
+        runBench(results, options, string("minimax/3x3/") + label, [&]() { return minimax(position, oToMove); });
+    }
+}
+
+// Function to benchmark one AI move per difficulty level on every board, with the game's own budgets
+void benchAI(vector<BenchResult>& results, const BenchOptions& options, ThreadPool& pool) {
+    for (int variantIndex = 0; variantIndex < VARIANT_COUNT; variantIndex++) {
+        Match match(variantIndex, &pool);
+        // X in the centre and O beside it, so every level has to think
+        int n = match.position().size();
+        match.play((n / 2) * n + n / 2);
+        match.play((n / 2) * n + n / 2 + 1);
+        for (int difficulty = 1; difficulty <= DIFFICULTY_COUNT; difficulty++) {
+            unsigned seed = 1;
+            string name = string("makeAIMove/") + VARIANTS[variantIndex].name + "/" + difficultyName(difficulty);
+            runBench(results, options, name, [&]() {
+                seed++;
+                return chooseAIMove(match.position(), match.currentPiece(), difficulty, AIBudget(), seed, seed * 2654435761u).cell;
+            }, 3);
+        }
+    }
+}
+
+// Function to time the parallel alpha-beta search against the single-threaded one at a fixed
+// depth on midgame 7x7 and 15x15 positions (one search each: they take a good fraction of a second)
+void benchSpeedup(vector<SpeedupResult>& speedups, const BenchOptions& options, ThreadPool& pool) {
+    using MediumBoard = BasicBoard<7, 5>;
+    using BigBoard = BasicBoard<15, 5>;
+    if (selected(options, "speedup/7x7")) {
+        cerr << "  speedup/7x7" << endl;
+        MediumBoard position = boardFrom<MediumBoard>(string(14, '.') + "...XO....OX......X...");
+        speedups.push_back({"speedup/7x7", measureSpeedup(position, 7, pool)});
+    }
+    if (selected(options, "speedup/15x15")) {
+        cerr << "  speedup/15x15" << endl;
+        BigBoard position = boardFrom<BigBoard>(string(6 * 15, '.') + ".......X.............OX.............OX..............O.......");
+        speedups.push_back({"speedup/15x15", measureSpeedup(position, 6, pool)});
+    }
+}
+
+// Function to benchmark one frame of particle updates at several particle counts
+void benchParticles(vector<BenchResult>& results, const BenchOptions& options) {
+    for (int count : {100, 10000, 100000}) {
+        ParticleSystem particles;
+        for (int i = 0; i < count; i++) {
+            float angle = static_cast<float>(i % 360) * 3.14159f / 180.0f;
+            particles.spawn(400, 300, cos(angle) * 100, sin(angle) * 100, 0xFF6464, 1e9f);
+        }
+        runBench(results, options, "ParticleSystem::update/" + to_string(count), [&]() {
+            particles.update(1.0f / 60.0f);
+            return static_cast<long long>(particles.size());
+        }, 1, count);
+    }
+}
+
+// Function to benchmark a full headless update() + render() frame into an offscreen texture
+void benchFrames(vector<BenchResult>& results, const BenchOptions& options) {
+    if (!selected(options, "frame/menu") && !selected(options, "frame/game")) return;
+    sf::RenderTexture texture;
+    if (!texture.create(800, 600)) {
+        cerr << "  frame benchmarks skipped: could not create an 800x600 render texture" << endl;
+        return;
+    }
+    TicTacToeGame game(texture);
+    runBench(results, options, "frame/menu", [&]() {
+        game.update(1.0f / 60.0f);
+        game.render();
+        return 1;
+    });
+    // A game in progress with a steady stream of particles
+    game.startGame(PLAYER_VS_PLAYER);
+    game.makeMove(1, 1);
+    game.makeMove(0, 0);
+    game.makeMove(2, 1);
+    runBench(results, options, "frame/game", [&]() {
+        game.createParticles(sf::Vector2f(400, 300));
+        game.update(1.0f / 60.0f);
+        game.render();
+        return 1;
+    });
+}
+
+// Function to time replaying an input recording headlessly; the per-item figure is per frame
+void benchReplay(vector<BenchResult>& results, const BenchOptions& options) {
+    if (options.replayPath.empty() || !selected(options, "replay")) return;
+    cerr << "  replay" << endl;
+    sf::RenderTexture texture;
+    if (!texture.create(800, 600)) {
+        cerr << "  replay skipped: could not create an 800x600 render texture" << endl;
+        return;
+    }
+    SessionOptions session;
+    session.replayPath = options.replayPath;
+    BenchResult result;
+    result.name = "replay";
+    // Each run needs a fresh game; only the replay itself is timed
+    while (result.totalMs < options.minTimeMs || result.iterations == 0) {
+        TicTacToeGame game(texture, session);
+        if (!game.replaying()) {
+            cerr << "  replay skipped: " << options.replayPath << " is not an input recording" << endl;
+            return;
+        }
+        auto start = chrono::steady_clock::now();
+        result.itemsPerOp = game.runReplay();
+        result.totalMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        result.iterations++;
+        if (!game.replaySucceeded()) {
+            cerr << "  replay diverged from the recording after " << game.simulationSteps() << " steps" << endl;
+        }
+    }
+    result.nsPerOp = result.totalMs * 1e6 / result.iterations;
+    results.push_back(result);
+}
+
+// Function to compare drawing particles one CircleShape at a time with the batched renderer
+void benchParticleDrawing(vector<BenchResult>& results, const BenchOptions& options) {
+    sf::RenderTexture texture;
+    if (!texture.create(800, 600)) {
+        cerr << "  particle drawing benchmarks skipped: could not create an 800x600 render texture" << endl;
+        return;
+    }
+    ParticleRenderer renderer;
+    for (int count : {1000, 10000, 100000}) {
+        ParticleSystem particles;
+        for (int i = 0; i < count; i++) {
+            particles.spawn(static_cast<float>(i % 800), static_cast<float>(i / 800 % 600), 0, 0,
+                            (i % 2) ? 0xFF6464 : 0x6464FF, 1e9f);
+        }
+        particles.update(0);
+        // The path render() used before batching: a fresh circle and a draw call per particle
+        runBench(results, options, "particles/draw/circles/" + to_string(count), [&]() {
+            texture.clear();
+            for (size_t i = 0; i < particles.size(); i++) {
+                uint32_t rgb = particles.colors()[i];
+                sf::CircleShape particle(3);
+                particle.setPosition(particles.positionsX()[i], particles.positionsY()[i]);
+                particle.setFillColor(sf::Color(rgb >> 16, (rgb >> 8) & 0xFF, rgb & 0xFF, particles.alphas()[i]));
+                texture.draw(particle);
+            }
+            texture.display();
+            return 1;
+        }, 3, count);
+        runBench(results, options, "particles/draw/batched/" + to_string(count), [&]() {
+            texture.clear();
+            renderer.draw(texture, particles);
+            texture.display();
+            return 1;
+        }, 3, count);
+    }
+}
+
+// Function to measure what a ProfileScope costs with the profiler off and on
+void benchProfiler(vector<BenchResult>& results, const BenchOptions& options) {
+    FrameProfiler profiler;
+    long long counter = 0;
+    runBench(results, options, "ProfileScope/disabled", [&]() {
+        ProfileScope scope(profiler, FrameProfiler::UPDATE);
+        clobber(counter);
+        return counter;
+    });
+    runBench(results, options, "ProfileScope/timing", [&]() {
+        profiler.setTiming(true);
+        ProfileScope scope(profiler, FrameProfiler::UPDATE);
+        clobber(counter);
+        return counter;
+    });
+    profiler.setTiming(false);
+}
+
+// Function to benchmark appending to the match journal and querying a million stored games
+void benchJournal(vector<BenchResult>& results, const BenchOptions& options) {
+    if (!selected(options, "journal/")) return;
+    const char* path = "bench_journal.bin";
+    const long long GAMES = 1000000;
+    unlink(path);
+    {
+        MatchJournal journal;
+        if (!journal.open(path)) {
+            cerr << "  journal benchmarks skipped: could not create " << path << endl;
+            return;
+        }
+        vector<int> moves = {4, 0, 8, 2, 1, 7, 6, 3, 5};
+        long long game = 0;
+        runBench(results, options, "journal/append", [&]() {
+            game++;
+            moves[0] = static_cast<int>(game % 9);
+            journal.append(game % 3 ? PLAYER_VS_AI : PLAYER_VS_PLAYER, static_cast<int>(game % 4) + 1, 0,
+                           static_cast<int>(game % 3), moves);
+            return 1;
+        });
+        while (journal.size() < static_cast<uint64_t>(GAMES)) {
+            moves[0] = static_cast<int>(journal.size() % 9);
+            journal.append(PLAYER_VS_AI, static_cast<int>(journal.size() % 4) + 1, 0, static_cast<int>(journal.size() % 3), moves);
+        }
+    }
+    MatchJournal journal;
+    auto start = chrono::steady_clock::now();
+    journal.open(path);
+    cerr << "  journal/open of " << journal.size() << " games took "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    runBench(results, options, "journal/query/difficulty", [&]() {
+        ResultCounts counts = journal.results(PLAYER_VS_AI, 3);
+        return static_cast<long long>(counts.oWins);
+    });
+    runBench(results, options, "journal/query/opening", [&]() {
+        ResultCounts counts = journal.openingResults(0, 4);
+        return static_cast<long long>(counts.xWins);
+    });
+    // A query the totals do not answer: every record is read
+    long long stored = static_cast<long long>(journal.size());
+    runBench(results, options, "journal/scan/centre-then-corner", [&]() {
+        long long wins = 0;
+        for (const MatchRecord& record : journal) {
+            wins += (record.moves[0] == 4) & (record.moves[1] == 0) & (record.winner == 1);
+        }
+        return wins;
+    }, 3, stored);
+    unlink(path);
+}
+
+// Function to benchmark encoding and decoding a game in the archive format
+void benchRecords(vector<BenchResult>& results, const BenchOptions& options) {
+    const int smallGame[] = {4, 0, 8, 2, 1, 7, 6, 3, 5};
+    // A 15x15 game that stays around the centre, as real ones do
+    int bigGame[100];
+    for (int k = 0; k < 100; k++) bigGame[k] = (5 + k / 10) * 15 + 3 + k % 10;
+    for (const auto& [label, size, moves, count] : {make_tuple("3x3", 3, smallGame, 9), make_tuple("15x15", 15, static_cast<const int*>(bigGame), 100)}) {
+        unsigned char buffer[record_format::MAX_RECORD_BYTES];
+        GameRecord record;
+        size_t bytes = record_format::encode(size, 1, moves, count, buffer);
+        runBench(results, options, string("record/encode/") + label, [&]() {
+            clobber(buffer);
+            return static_cast<long long>(record_format::encode(size, 1, moves, count, buffer));
+        });
+        runBench(results, options, string("record/decode/") + label, [&]() {
+            clobber(buffer);
+            return static_cast<long long>(record_format::decode(size, buffer, buffer + bytes, record));
+        });
+    }
+}
+
+// Function to benchmark the transposition table, and a fixed-depth 4x4 search with and without it
+void benchTranspositionTable(vector<BenchResult>& results, const BenchOptions& options) {
+    TranspositionTable table(1 << 16);
+    TTCounters counters;
+    uint64_t key = 1;
+    runBench(results, options, "table/store", [&]() {
+        key = zobrist::mix(key);
+        TTEntry entry;
+        entry.score = 1;
+        entry.move = 3;
+        entry.depth = 4;
+        entry.bound = TT_EXACT;
+        table.store(key, entry, counters);
+        return 1;
+    });
+    runBench(results, options, "table/probe", [&]() {
+        key = zobrist::mix(key);
+        TTEntry entry;
+        return table.probe(key, entry, counters) ? 1 : 0;
+    });
+
+    using Board4 = BasicBoard<4, 4>;
+    Board4 position = boardFrom<Board4>("X....O..........");
+    SearchLimits limits;
+    limits.maxDepth = 8;
+    limits.useSolvedTable = false;
+    AlphaBetaSearch<Board4> plain;
+    runBench(results, options, "search/4x4/depth8", [&]() { return plain.search(position, limits).nodes; });
+    AlphaBetaSearch<Board4> withTable;
+    TranspositionTable searchTable(1 << 14);
+    withTable.setTable(&searchTable);
+    runBench(results, options, "search/4x4/depth8/table", [&]() {
+        searchTable.clear();
+        return withTable.search(position, limits).nodes;
+    });
+}
+
+// Function to benchmark opening and probing an opening book built from random 7x7 games
+void benchOpeningBook(vector<BenchResult>& results, const BenchOptions& options) {
+    if (!selected(options, "book/")) return;
+    const char* path = "bench_book.bin";
+    OpeningBookBuilder builder(6);
+    Match match(2);
+    for (unsigned game = 1; game <= 200000; game++) {
+        match.reset();
+        unsigned state = game;
+        while (!match.isOver()) {
+            state = state * 1664525u + 1013904223u;
+            match.play(match.position().randomMove(state >> 8));
+        }
+        builder.addGame(match.position().size(), match.moves(), match.winner());
+    }
+    long long entries = builder.write(path, 1);
+    OpeningBook book;
+    auto start = chrono::steady_clock::now();
+    if (entries < 0 || !book.open(path)) {
+        cerr << "  book benchmarks skipped: could not write " << path << endl;
+        return;
+    }
+    cerr << "  book/open of " << entries << " entries took "
+         << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+    match.reset();
+    match.play(24);
+    match.play(25);
+    runBench(results, options, "book/probe/7x7", [&]() {
+        return static_cast<long long>(book.probe(match.position()).cell);
+    });
+    unlink(path);
+}
+
+// Function to benchmark building a 4x4 endgame tablebase and probing it through the mapped file
+void benchTablebase(vector<BenchResult>& results, const BenchOptions& options, ThreadPool& pool) {
+    if (!selected(options, "tablebase/")) return;
+    const char* path = "bench_tablebase.bin";
+    TablebaseLayout layout(4, 4, 4);
+    TablebaseBuilder builder(layout);
+    auto start = chrono::steady_clock::now();
+    builder.solve(pool);
+    double solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    long long bytes = builder.write(path);
+    Tablebase table;
+    if (bytes < 0 || !table.open(path)) {
+        cerr << "  tablebase benchmarks skipped: could not write " << path << endl;
+        return;
+    }
+    cerr << "  tablebase/build of " << layout.entryCount() << " positions (" << bytes << " bytes) took " << solveMs << " ms" << endl;
+    // A game in progress with four empty cells left
+    Match match(1);
+    for (unsigned seed = 1; match.position().cellCount() - static_cast<int>(match.moves().size()) != 4 || match.isOver(); seed++) {
+        match.reset();
+        unsigned state = seed;
+        while (!match.isOver() && match.moves().size() < 12) {
+            state = state * 1664525u + 1013904223u;
+            match.play(match.position().randomMove(state >> 8));
+        }
+    }
+    runBench(results, options, "tablebase/probe/4x4", [&]() {
+        return static_cast<long long>(table.probe(match.position()).cell);
+    });
+    unlink(path);
+}
+
+// Function to print the results as a JSON document
+void printJson(const vector<BenchResult>& results, const vector<SpeedupResult>& speedups) {
+    cout << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        cout << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+             << ", \"total_ms\": " << r.totalMs << ", \"ns_per_op\": " << r.nsPerOp;
+        if (r.itemsPerOp > 1) cout << ", \"items_per_op\": " << r.itemsPerOp << ", \"ns_per_item\": " << r.nsPerOp / r.itemsPerOp;
+        cout << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    cout << "  ],\n  \"speedup\": [\n";
+    for (size_t i = 0; i < speedups.size(); i++) {
+        const SpeedupReport& r = speedups[i].report;
+        cout << "    {\"name\": \"" << speedups[i].name << "\", \"depth\": " << r.depth << ", \"threads\": " << r.threads
+             << ", \"sequential_nodes\": " << r.sequentialNodes << ", \"parallel_nodes\": " << r.parallelNodes
+             << ", \"sequential_ms\": " << r.sequentialMs << ", \"parallel_ms\": " << r.parallelMs
+             << ", \"speedup\": " << r.speedup << "}" << (i + 1 < speedups.size() ? "," : "") << "\n";
+    }
+    cout << "  ]\n}" << endl;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--filter") options.filter = argv[i + 1];
+        else if (arg == "--min-time") options.minTimeMs = atof(argv[i + 1]);
+        else if (arg == "--replay") options.replayPath = argv[i + 1];
+        else if (arg == "--threads") options.threads = max(1, atoi(argv[i + 1]));
+    }
+
+    // The thread asking for a search works alongside the pool's workers
+    ThreadPool pool(options.threads - 1);
+    vector<BenchResult> results;
+    vector<SpeedupResult> speedups;
+    cerr << "Running benchmarks" << endl;
+    benchRules(results, options);
+    benchAI(results, options, pool);
+    benchParticles(results, options);
+    benchParticleDrawing(results, options);
+    benchProfiler(results, options);
+    benchJournal(results, options);
+    benchRecords(results, options);
+    benchOpeningBook(results, options);
+    benchTablebase(results, options, pool);
+    benchTranspositionTable(results, options);
+    benchFrames(results, options);
+    benchReplay(results, options);
+    benchSpeedup(speedups, options, pool);
+    printJson(results, speedups);
+    return 0;
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Cell states
+enum CellState {
+    EMPTY,
+    X_PLAYER,
+    O_PLAYER
+};
+
+// Returns the opponent of the given player
+constexpr CellState opponentOf(CellState player) {
+    return (player == X_PLAYER) ? O_PLAYER : X_PLAYER;
+}
+
+// Fixed-size bit set over the cells of a board, usable in constant expressions
+template <int BITS>
+class BitMask {
+public:
+    static constexpr int WORDS = (BITS + 63) / 64;
+
+    constexpr BitMask() : words{} {}
+
+    // Mask with every valid bit set
+    static constexpr BitMask full() {
+        BitMask mask;
+        for (int w = 0; w < WORDS; w++) {
+            int bits = BITS - w * 64;
+            mask.words[w] = (bits >= 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << bits) - 1;
+        }
+        return mask;
+    }
+    static constexpr BitMask single(int bit) {
+        BitMask mask;
+        mask.set(bit);
+        return mask;
+    }
+
+    constexpr bool test(int bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    constexpr void set(int bit) { words[bit >> 6] |= std::uint64_t(1) << (bit & 63); }
+    constexpr void reset(int bit) { words[bit >> 6] &= ~(std::uint64_t(1) << (bit & 63)); }
+
+    constexpr bool any() const {
+        for (std::uint64_t word : words) {
+            if (word) return true;
+        }
+        return false;
+    }
+    constexpr bool none() const { return !any(); }
+    constexpr int count() const {
+        int total = 0;
+        for (std::uint64_t word : words) total += std::popcount(word);
+        return total;
+    }
+    // Index of the lowest set bit, -1 when empty
+    constexpr int lowest() const {
+        for (int w = 0; w < WORDS; w++) {
+            if (words[w]) return w * 64 + std::countr_zero(words[w]);
+        }
+        return -1;
+    }
+    // Clears the lowest set bit and returns its index (the mask must not be empty)
+    constexpr int popLowest() {
+        for (int w = 0; w < WORDS; w++) {
+            if (words[w]) {
+                int bit = std::countr_zero(words[w]);
+                words[w] &= words[w] - 1;
+                return w * 64 + bit;
+            }
+        }
+        return -1;
+    }
+    // True when every bit of other is also set here
+    constexpr bool contains(const BitMask& other) const {
+        for (int w = 0; w < WORDS; w++) {
+            if ((words[w] & other.words[w]) != other.words[w]) return false;
+        }
+        return true;
+    }
+    constexpr bool intersects(const BitMask& other) const {
+        for (int w = 0; w < WORDS; w++) {
+            if (words[w] & other.words[w]) return true;
+        }
+        return false;
+    }
+    constexpr std::uint64_t word(int w) const { return words[w]; }
+
+    constexpr BitMask& operator&=(const BitMask& other) {
+        for (int w = 0; w < WORDS; w++) words[w] &= other.words[w];
+        return *this;
+    }
+    constexpr BitMask& operator|=(const BitMask& other) {
+        for (int w = 0; w < WORDS; w++) words[w] |= other.words[w];
+        return *this;
+    }
+    constexpr BitMask operator&(const BitMask& other) const { BitMask r = *this; r &= other; return r; }
+    constexpr BitMask operator|(const BitMask& other) const { BitMask r = *this; r |= other; return r; }
+    // Complement restricted to the valid bits
+    constexpr BitMask operator~() const {
+        BitMask r = full();
+        for (int w = 0; w < WORDS; w++) r.words[w] &= ~words[w];
+        return r;
+    }
+
+    constexpr bool operator==(const BitMask& other) const = default;
+
+private:
+    std::array<std::uint64_t, WORDS> words;
+};
+
+// Number of K-in-a-row windows on an N x N board: rows, columns and both diagonal directions
+constexpr int lineCount(int n, int k) {
+    return 2 * n * (n - k + 1) + 2 * (n - k + 1) * (n - k + 1);
+}
+
+// Builds the table of every K-cell window along rows, columns and both diagonals
+template <int N, int K>
+constexpr std::array<BitMask<N * N>, lineCount(N, K)> buildWinMasks() {
+    std::array<BitMask<N * N>, lineCount(N, K)> masks{};
+    constexpr int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+    int n = 0;
+    for (const auto& dir : directions) {
+        for (int row = 0; row < N; row++) {
+            for (int col = 0; col < N; col++) {
+                int endRow = row + (K - 1) * dir[0];
+                int endCol = col + (K - 1) * dir[1];
+                if (endRow < 0 || endRow >= N || endCol < 0 || endCol >= N) continue;
+                for (int k = 0; k < K; k++) masks[n].set((row + k * dir[0]) * N + col + k * dir[1]);
+                n++;
+            }
+        }
+    }
+    return masks;
+}
+
+// For every cell, the indices of the win lines passing through it
+template <int N, int K>
+struct CellLineTable {
+    static constexpr int MAX_PER_CELL = 4 * K;
+    std::array<std::array<std::int16_t, MAX_PER_CELL>, N * N> lines{};
+    std::array<std::uint8_t, N * N> count{};
+};
+
+template <int N, int K>
+constexpr CellLineTable<N, K> buildCellLines(const std::array<BitMask<N * N>, lineCount(N, K)>& masks) {
+    CellLineTable<N, K> table;
+    for (int line = 0; line < lineCount(N, K); line++) {
+        BitMask<N * N> cells = masks[line];
+        while (cells.any()) {
+            int cell = cells.popLowest();
+            table.lines[cell][table.count[cell]++] = static_cast<std::int16_t>(line);
+        }
+    }
+    return table;
+}
+
+// For every cell, the mask of the cells within one step in any direction (excluding itself)
+template <int N>
+constexpr std::array<BitMask<N * N>, N * N> buildNeighbourMasks() {
+    std::array<BitMask<N * N>, N * N> masks{};
+    for (int cell = 0; cell < N * N; cell++) {
+        int row = cell / N;
+        int col = cell % N;
+        for (int dRow = -1; dRow <= 1; dRow++) {
+            for (int dCol = -1; dCol <= 1; dCol++) {
+                int r = row + dRow;
+                int c = col + dCol;
+                if ((dRow || dCol) && r >= 0 && r < N && c >= 0 && c < N) masks[cell].set(r * N + c);
+            }
+        }
+    }
+    return masks;
+}
+
+// Bitboard position for an N x N board won by K in a row: one mask per player,
+// bit (row * N + col) set when occupied
+template <int N, int K>
+class BasicBoard {
+    static_assert(K >= 2 && K <= N, "win length must fit on the board");
+
+public:
+    static constexpr int SIZE = N;
+    static constexpr int WIN_LENGTH = K;
+    static constexpr int CELLS = N * N;
+    static constexpr int LINE_COUNT = lineCount(N, K);
+    using Mask = BitMask<CELLS>;
+
+    static constexpr Mask FULL_MASK = Mask::full();
+    static constexpr std::array<Mask, LINE_COUNT> WIN_MASKS = buildWinMasks<N, K>();
+    static constexpr CellLineTable<N, K> CELL_LINES = buildCellLines<N, K>(WIN_MASKS);
+    static constexpr std::array<Mask, CELLS> NEIGHBOURS = buildNeighbourMasks<N>();
+
+    constexpr BasicBoard() : xMask(), oMask() {}
+    constexpr BasicBoard(const Mask& x, const Mask& o) : xMask(x), oMask(o) {}
+
+    static constexpr int cellIndex(int row, int col) { return row * SIZE + col; }
+    static constexpr int rowOf(int cell) { return cell / SIZE; }
+    static constexpr int colOf(int cell) { return cell % SIZE; }
+
+    // Function to read the state of a cell
+    constexpr CellState at(int cell) const {
+        if (xMask.test(cell)) return X_PLAYER;
+        if (oMask.test(cell)) return O_PLAYER;
+        return EMPTY;
+    }
+    constexpr CellState at(int row, int col) const { return at(cellIndex(row, col)); }
+
+    constexpr bool isEmpty(int cell) const { return !xMask.test(cell) && !oMask.test(cell); }
+
+    // Function to place a piece on an empty cell
+    constexpr void place(int cell, CellState player) {
+        if (player == X_PLAYER) xMask.set(cell); else oMask.set(cell);
+    }
+    // Function to remove a piece from a cell (used to undo moves during search)
+    constexpr void clear(int cell) {
+        xMask.reset(cell);
+        oMask.reset(cell);
+    }
+
+    constexpr const Mask& playerMask(CellState player) const {
+        return (player == X_PLAYER) ? xMask : oMask;
+    }
+    constexpr Mask occupiedMask() const { return xMask | oMask; }
+    // Legal moves are simply the empty cells
+    constexpr Mask emptyMask() const { return ~(xMask | oMask); }
+    constexpr int moveCount() const { return xMask.count() + oMask.count(); }
+
+    // X always moves first, so the side to move follows from the piece counts
+    constexpr CellState sideToMove() const {
+        return (xMask.count() > oMask.count()) ? O_PLAYER : X_PLAYER;
+    }
+
+    // Function to check whether a player owns a complete line
+    constexpr bool hasWin(CellState player) const {
+        const Mask& mask = playerMask(player);
+        for (const Mask& line : WIN_MASKS) {
+            if (mask.contains(line)) return true;
+        }
+        return false;
+    }
+    // Function to check whether the piece on a cell completes a line, looking only at lines through it
+    constexpr bool completesLine(int cell, CellState player) const {
+        const Mask& mask = playerMask(player);
+        for (int i = 0; i < CELL_LINES.count[cell]; i++) {
+            if (mask.contains(WIN_MASKS[CELL_LINES.lines[cell][i]])) return true;
+        }
+        return false;
+    }
+    // Function to check for a win by either player
+    constexpr bool checkWin() const { return hasWin(X_PLAYER) || hasWin(O_PLAYER); }
+    // Function to check whether the board is full
+    constexpr bool isFull() const { return occupiedMask() == FULL_MASK; }
+    // Function to check whether the game has ended
+    constexpr bool isTerminal() const { return isFull() || checkWin(); }
+
+    // Function to reset the board to the empty position
+    constexpr void reset() {
+        xMask = Mask();
+        oMask = Mask();
+    }
+
+    constexpr bool operator==(const BasicBoard& other) const = default;
+
+private:
+    Mask xMask;
+    Mask oMask;
+};
+
+// The classic game
+using Board = BasicBoard<3, 3>;
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Turns a font file into embedded_font.h, so the game can load its font from memory
+// instead of from the working directory (see ui_font.h).
+//
+//   embed_font FONT.TTF [OUTPUT]       OUTPUT defaults to embedded_font.h
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        cerr << "usage: embed_font FONT.TTF [OUTPUT]" << endl;
+        return 1;
+    }
+    string outputPath = (argc == 3) ? argv[2] : "embedded_font.h";
+
+    ifstream input(argv[1], ios::binary);
+    if (!input) {
+        cerr << "Could not open " << argv[1] << endl;
+        return 1;
+    }
+    vector<unsigned char> bytes((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+    if (bytes.empty()) {
+        cerr << argv[1] << " is empty" << endl;
+        return 1;
+    }
+
+    ofstream output(outputPath);
+    output << "#pragma once\n\n#include <cstddef>\n\n"
+           << "// Generated by embed_font from " << argv[1] << "; do not edit\n"
+           << "inline constexpr unsigned char EMBEDDED_FONT[] = {";
+    const char* digits = "0123456789abcdef";
+    for (size_t i = 0; i < bytes.size(); i++) {
+        output << (i % 16 == 0 ? "\n    " : " ") << "0x" << digits[bytes[i] >> 4] << digits[bytes[i] & 15] << ',';
+    }
+    output << "\n};\ninline constexpr std::size_t EMBEDDED_FONT_SIZE = sizeof(EMBEDDED_FONT);\n";
+    if (!output.flush()) {
+        cerr << "Could not write " << outputPath << endl;
+        return 1;
+    }
+    cout << "Embedded " << bytes.size() << " bytes of " << argv[1] << " in " << outputPath << endl;
+    return 0;
+}
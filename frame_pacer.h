@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+
+// Bookkeeping for the adaptive game loop. The loop renders at full rate while something
+// animates and blocks on the next event when nothing does; this records how long it was
+// blocked so the idle fraction can be reported, and how recently there was any input so
+// ambient animations (the pulsing title, the background) can settle after a while.
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+    // How long ambient animations keep running after the last input
+    static constexpr std::chrono::seconds AMBIENT_TIME{5};
+
+    FramePacer() : started(Clock::now()), lastActivity(started), idleSince(started), idleTime(0), frames(0), wakeups(0) {}
+
+    // Function to record input, which restarts the ambient animations
+    void noteActivity() { lastActivity = Clock::now(); }
+    bool ambientActive() const { return Clock::now() - lastActivity < AMBIENT_TIME; }
+
+    // Function to mark the start and end of a blocking wait for events
+    void beginIdle() { idleSince = Clock::now(); }
+    void endIdle() {
+        idleTime += Clock::now() - idleSince;
+        wakeups++;
+    }
+    void frameRendered() { frames++; }
+
+    long long frameCount() const { return frames; }
+    long long wakeupCount() const { return wakeups; }
+    double elapsedSeconds() const { return std::chrono::duration<double>(Clock::now() - started).count(); }
+    double idleSeconds() const { return std::chrono::duration<double>(idleTime).count(); }
+    // Fraction of the run spent blocked instead of rendering
+    double idleFraction() const {
+        double elapsed = elapsedSeconds();
+        return elapsed > 0 ? idleSeconds() / elapsed : 0;
+    }
+
+private:
+    Clock::time_point started;
+    Clock::time_point lastActivity;
+    Clock::time_point idleSince;
+    Clock::duration idleTime;
+    long long frames;
+    long long wakeups;
+};
@@ -0,0 +1,1300 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "board.h"
+#include "frame_pacer.h"
+#include "game_logic.h"
+#include "input_recording.h"
+#include "match_journal.h"
+#include "particle_renderer.h"
+#include "particle_system.h"
+#include "profiler.h"
+#include "sound_engine.h"
+#include "ui_font.h"
+#include "variant.h"
+#include "xoshiro.h"
+
+// Game States
+enum GameState {
+    MENU,
+    MODE_SELECT,
+    PLAYING,
+    GAME_OVER,
+    SETTINGS
+};
+
+// Parts of the retained UI that must be rebuilt before the next frame
+enum UIDirty : unsigned {
+    DIRTY_BOARD = 1 << 0,
+    DIRTY_STATUS = 1 << 1,
+    DIRTY_STATS = 1 << 2,
+    DIRTY_DIFFICULTY = 1 << 3,
+    DIRTY_AI_INFO = 1 << 4,
+    DIRTY_ALL = (1 << 5) - 1
+};
+
+// Input for one frame. The mouse and keyboard are read once at the start of the frame and
+// everything that reacts to them reads this instead of querying the OS again.
+struct InputSnapshot {
+    sf::Vector2i mouse;
+    bool mouseDown;
+    bool escapeDown;
+    // Set when a click or key press has been handled but not yet presented, and when it was handled
+    bool awaitingPresent;
+    std::chrono::steady_clock::time_point inputTime;
+
+    InputSnapshot() : mouse(-1, -1), mouseDown(false), escapeDown(false), awaitingPresent(false) {}
+};
+
+// Where a session's input comes from: the player, the player with a recording kept, or a recording
+struct SessionOptions {
+    std::uint64_t seed = 0;      // seeds every random stream; 0 takes one from the clock
+    std::string recordPath;      // record the input to this file
+    std::string replayPath;      // replay this recording instead of reading the mouse and keyboard
+    int threads = 0;             // threads the Hard and Expert AI search with; 0 uses every core
+
+    // Workers of the search pool; the thread asking for a move searches alongside them
+    int searchWorkers() const {
+        int total = (threads > 0) ? threads : static_cast<int>(std::thread::hardware_concurrency());
+        return std::max(0, total - 1);
+    }
+    // Recording and replaying need the AI to be a function of the position and seed alone
+    bool deterministic() const { return !recordPath.empty() || !replayPath.empty(); }
+};
+
+// Button class. The gradient fill and the outline share one vertex array, so a button costs
+// two draw calls (geometry and label), and its colours are only rewritten when its state changes.
+class Button {
+private:
+    sf::Text text;
+    sf::Font* font;
+    SoundEngine* sounds;
+    sf::Vector2f position;
+    sf::Vector2f size;
+    sf::Color baseColor;
+    sf::Color hoverColor;
+    sf::Color clickColor;
+    sf::Color currentColor;
+    // Four fill vertices followed by the four quads of the outline
+    sf::VertexArray geometry;
+    bool isPressed;
+    bool wasPressed;
+    bool hovered;
+    float scale;
+    float animationTime;
+
+    static constexpr float OUTLINE = 2.0f;
+
+    // function to place one quad of the geometry
+    void setQuad(int first, float left, float top, float width, float height, sf::Color color) {
+        geometry[first].position = sf::Vector2f(left, top);
+        geometry[first + 1].position = sf::Vector2f(left + width, top);
+        geometry[first + 2].position = sf::Vector2f(left + width, top + height);
+        geometry[first + 3].position = sf::Vector2f(left, top + height);
+        for (int i = 0; i < 4; i++) geometry[first + i].color = color;
+    }
+
+public:
+// Constructor
+    Button(float x, float y, float width, float height, const  std::string& buttonText, sf::Font* f, SoundEngine* s) {
+        position = sf::Vector2f(x, y);
+        size = sf::Vector2f(width, height);
+        font = f;
+        sounds = s;
+        // Set colors
+        baseColor = sf::Color(60, 60, 120);
+        hoverColor = sf::Color(100, 100, 180);
+        clickColor = sf::Color(80, 80, 160);
+        // Create the gradient fill and the outline around it
+        geometry = sf::VertexArray(sf::Quads, 20);
+        sf::Color outlineColor(200, 200, 255, 200);
+        setQuad(0, x, y, width, height, baseColor);
+        setQuad(4, x - OUTLINE, y - OUTLINE, width + 2 * OUTLINE, OUTLINE, outlineColor);
+        setQuad(8, x - OUTLINE, y + height, width + 2 * OUTLINE, OUTLINE, outlineColor);
+        setQuad(12, x - OUTLINE, y, OUTLINE, height, outlineColor);
+        setQuad(16, x + width, y, OUTLINE, height, outlineColor);
+        // Update gradient colors
+        currentColor = sf::Color::Transparent;
+        updateGradient(baseColor);
+        // Set text properties
+        text.setFont(*font);
+        text.setCharacterSize(28);
+        text.setFillColor(sf::Color(220, 220, 255));
+        setLabel(buttonText);
+        // Initialize state variables
+        isPressed = false;
+        wasPressed = false;
+        hovered = false;
+        scale = 1.0f;
+        animationTime = 0.0f;
+    }
+    // function to change the button text and re-center it
+    void setLabel(const std::string& buttonText) {
+        text.setString(buttonText);
+        sf::FloatRect textBounds = text.getLocalBounds();
+        text.setPosition(
+            position.x + (size.x - textBounds.width) / 2 - textBounds.left,
+            position.y + (size.y - textBounds.height) / 2 - 5
+        );
+    }
+    // function to update the gradient colors based on the button state
+    void updateGradient(sf::Color color) {
+        if (color == currentColor) return;
+        currentColor = color;
+        geometry[0].color = color;
+        geometry[1].color = sf::Color(color.r * 0.8f, color.g * 0.8f, color.b * 0.8f);
+        geometry[2].color = sf::Color(color.r * 0.6f, color.g * 0.6f, color.b * 0.6f);
+        geometry[3].color = sf::Color(color.r * 0.8f, color.g * 0.8f, color.b * 0.8f);
+    }
+    // function to update the button state based on mouse position and click
+    void update(sf::Vector2i mousePos, bool mousePressed, float deltaTime) {
+        // Check if mouse is over the button, outline included, at its current scale
+        sf::FloatRect bounds(position.x - OUTLINE * scale, position.y - OUTLINE * scale,
+                             (size.x + 2 * OUTLINE) * scale, (size.y + 2 * OUTLINE) * scale);
+        bool mouseOver = bounds.contains(static_cast<float>(mousePos.x), static_cast<float>(mousePos.y));
+        hovered = mouseOver;
+        // Update shape color based on mouse state
+        wasPressed = isPressed;
+        isPressed = mouseOver && mousePressed;
+        // Update shape fill color
+        animationTime += deltaTime;
+        
+        float targetScale = mouseOver ? 1.05f : 1.0f;
+        scale += (targetScale - scale) * std::min(deltaTime * 5.0f, 1.0f);
+        // Snap the last fraction of a pixel so the easing settles and the loop can go idle
+        if (std::abs(targetScale - scale) < 0.001f) scale = targetScale;
+        // Update gradient color based on button state
+        sf::Color targetColor = isPressed ? clickColor : (mouseOver ? hoverColor : baseColor);
+        updateGradient(targetColor);
+    }
+    // function to check whether the hover easing is still running
+    bool isAnimating() const {
+        return scale != (hovered ? 1.05f : 1.0f);
+    }
+    // function to check if the button was clicked, with a click sound when it was
+    bool isClicked() {
+        bool clicked = wasPressed && !isPressed;
+        if (clicked && sounds) sounds->play(SOUND_CLICK);
+        return clicked;
+    }
+
+    // function to draw the button, grown around its top-left corner by the hover animation
+    void draw(sf::RenderTarget& target) {
+        sf::RenderStates states;
+        states.transform.scale(scale, scale, position.x, position.y);
+        target.draw(geometry, states);
+        target.draw(text, states);
+    }
+};
+
+// Tic-Tac-Toe Game Class
+class TicTacToeGame {
+private:
+    // When construction began (before the window opens), for the startup-to-first-frame time
+    std::chrono::steady_clock::time_point constructedAt;
+    sf::RenderWindow window;
+    // Where frames are drawn: the window, or an offscreen texture when running headless
+    sf::RenderTarget* target;
+    sf::RenderTexture* offscreen;
+    // Input source and seed the session was started with
+    SessionOptions session;
+    sf::Font font;
+    sf::Font titleFont;
+    
+    GameState currentState;
+    GameMode currentMode;
+    // Worker threads shared by the parallel search
+    ThreadPool searchPool;
+    // Rules, turn order and AI for the selected board size
+    Match match;
+    // UI elements
+    Button* menuButtons[4];
+    Button* modeButtons[3];
+    Button* gameOverButtons[2];
+    // UI elements for grid lines, cells, and texts, laid out from the board size
+    std::vector<sf::RectangleShape> gridLines;
+    std::vector<sf::RectangleShape> cells;
+    std::vector<sf::Text> cellTexts;
+    float cellPitch;
+    float cellGap;
+    sf::Text titleText;
+    sf::Text statusText;
+    sf::Text statsText;
+    sf::Text searchInfoText;
+    std::string aiInfo;
+    sf::VertexArray backgroundGradient;
+    // Text that only changes with the game state: built once, refreshed when marked dirty
+    sf::Text subtitleText;
+    sf::Text difficultyText;
+    sf::Text modeTitleText;
+    sf::Text settingsTitleText;
+    sf::Text statsDisplayText;
+    sf::Text backText;
+    sf::RectangleShape hoverCell;
+    // Retained rendering: what changed since the last frame, and the static layer of the current screen
+    unsigned dirty;
+    bool layerValid;
+    GameState layerState;
+    bool layerCached;
+    sf::RenderTexture staticLayer;
+    sf::Sprite staticLayerSprite;
+    
+    // Sound effects, synthesized at startup and played from a fixed pool of voices
+    SoundEngine sounds;
+    // Particles for visual effects, grown on demand and drawn in one batch
+    ParticleSystem particles;
+    ParticleRenderer particleRenderer;
+    // Book moves for the Hard and Expert levels, built by selfplay --build-book
+    OpeningBook openingBook;
+    // Endgame tablebases of the boards that have one (tablebase_NxN.bin, built by the tablebase tool)
+    Tablebase tablebases[VARIANT_COUNT];
+    // Game statistics, kept in memory and backed by the match journal
+    GameStats stats;
+    MatchJournal journal;
+    
+    float animationTime;
+    sf::Color backgroundColor;
+    // Fixed-step simulation: steps taken so far, and how far real time has run past the last one
+    std::uint32_t simStep;
+    float renderLead;
+    // Random streams of the AI and the particle effects, both derived from the session seed
+    std::uint64_t sessionSeed;
+    Xoshiro256 aiRandom;
+    Xoshiro256 particleRandom;
+    // The recording being written, or the one being replayed and how the replay went
+    InputRecorder recorder;
+    sf::Vector2i recordedMouse;
+    std::uint8_t recordedButtons;
+    InputReplay replay;
+    bool replayDone;
+    bool replayDiverged;
+    bool replayMatched;
+    
+    int aiDifficulty;  // 1 Easy, 2 Medium, 3 Hard, 4 Expert
+    // Statistics of the last Hard mode search
+    SearchResult lastSearch;
+    // How much work each AI level may spend on a move
+    AIBudget aiBudget;
+    // AI move being computed off the render thread
+    std::future<AIMove> pendingAIMove;
+    std::atomic<bool> aiAbort;
+    bool aiThinking;
+    // Idle accounting for the adaptive game loop
+    FramePacer pacer;
+    // Phase timings behind the F3 overlay and the F4 trace
+    FrameProfiler profiler;
+    sf::Text overlayText;
+    float overlayRefresh;
+    // This frame's mouse and keyboard state
+    InputSnapshot input;
+    // Startup timings: glyph prewarming (off-thread) and construction to the first presented frame
+    double glyphWarmupMs;
+    double startupMs;
+    bool firstFramePresented;
+    
+public:
+    // The simulation advances in fixed steps of this many seconds whatever the frame rate
+    static constexpr float SIM_STEP = 1.0f / 120.0f;
+    // Steps one frame may run to catch up; time beyond that (a stall, a debugger) is dropped
+    static constexpr int MAX_STEPS_PER_FRAME = 8;
+
+    // Constructor to initialize the game
+    explicit TicTacToeGame(const SessionOptions& options = SessionOptions()) : constructedAt(std::chrono::steady_clock::now()),
+                      window(sf::VideoMode(800, 600), "Advanced Tic-Tac-Toe", sf::Style::Titlebar | sf::Style::Close),
+                      target(&window), offscreen(nullptr), session(options),
+                      searchPool(options.searchWorkers()),
+                      match(0, options.deterministic() ? nullptr : &searchPool) {
+        window.setFramerateLimit(60);
+        initialize();
+    }
+    // Constructor to run the game without a window, rendering into an 800x600 offscreen texture
+    explicit TicTacToeGame(sf::RenderTexture& texture, const SessionOptions& options = SessionOptions())
+                    : constructedAt(std::chrono::steady_clock::now()), target(&texture), offscreen(&texture), session(options),
+                      searchPool(options.searchWorkers()),
+                      match(0, options.deterministic() ? nullptr : &searchPool) {
+        initialize();
+    }
+    // Destructor to clean up resources
+    ~TicTacToeGame() {
+        finishRecording();
+        cancelAIMove();
+        for (int i = 0; i < 4; i++) delete menuButtons[i];
+        for (int i = 0; i < 3; i++) delete modeButtons[i];
+        for (int i = 0; i < 2; i++) delete gameOverButtons[i];
+        if (!offscreen && !replay.isOpen()) saveStats();
+    }
+    // Function to set up the state shared by both constructors
+    void initialize() {
+        bool fontLoaded = loadUIFont(font);
+        if (!fontLoaded) {
+            std::cerr << "Warning: Could not load the UI font (no embedded_font.h and no ARIAL.TTF), text will not be drawn" << std::endl;
+        }
+        titleFont = font;
+        // Rasterize every glyph the UI can draw while the rest of startup runs. Nothing may
+        // touch either font until the warm-up is joined below.
+        std::future<double> glyphWarmup;
+        if (fontLoaded) glyphWarmup = std::async(std::launch::async, [this]() { return prewarmUIGlyphs(); });
+        glyphWarmupMs = 0;
+        startupMs = 0;
+        firstFramePresented = false;
+        dirty = DIRTY_ALL;
+        layerValid = false;
+        currentState = MENU;
+        layerState = MENU;
+        currentMode = PLAYER_VS_PLAYER;
+        aiDifficulty = 2;
+        aiAbort = false;
+        aiThinking = false;
+        overlayRefresh = 0;
+        startSession();
+        // Headless runs have no audio device to play on
+        if (!offscreen && !sounds.initialize()) {
+            std::cerr << "Warning: Could not set up audio, playing without sound" << std::endl;
+        }
+        // Initialize game state
+        initializeGame();
+        // A replay shows the recorded games but keeps them out of the statistics
+        if (!offscreen && !replay.isOpen()) loadStats();
+        openingBook.open("opening_book.bin");
+        for (int i = 0; i < VARIANT_COUNT; i++) tablebases[i].open(std::string("tablebase_") + VARIANTS[i].name + ".bin");
+        if (glyphWarmup.valid()) glyphWarmupMs = glyphWarmup.get();
+        initializeUI();
+        
+        animationTime = 0;
+        backgroundColor = sf::Color(20, 20, 30);
+        // Create a gradient for the background
+        backgroundGradient = sf::VertexArray(sf::Quads, 4);
+        backgroundGradient[0].position = sf::Vector2f(0, 0);
+        backgroundGradient[1].position = sf::Vector2f(800, 0);
+        backgroundGradient[2].position = sf::Vector2f(800, 600);
+        backgroundGradient[3].position = sf::Vector2f(0, 600);
+        updateBackgroundGradient();
+    }
+    // Function to pick the session seed, seed the random streams and open the recording or replay
+    void startSession() {
+        simStep = 0;
+        renderLead = 0;
+        replayDone = false;
+        replayDiverged = false;
+        replayMatched = false;
+        recordedMouse = input.mouse;
+        recordedButtons = 0;
+        sessionSeed = session.seed;
+        if (!session.replayPath.empty()) {
+            if (replay.open(session.replayPath)) {
+                sessionSeed = replay.seed();
+            } else {
+                std::cerr << "Warning: " << session.replayPath << " is not an input recording, playing live" << std::endl;
+            }
+        }
+        if (sessionSeed == 0) sessionSeed = static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count()) | 1;
+        aiRandom.reseed(sessionSeed, 1);
+        particleRandom.reseed(sessionSeed, 2);
+        if (!session.recordPath.empty() && !replay.isOpen() && !recorder.open(session.recordPath, sessionSeed)) {
+            std::cerr << "Warning: Could not create " << session.recordPath << ", playing without recording" << std::endl;
+        }
+        // A time budget finishes at a different point on every run; a work budget always at the same one.
+        // The shared search pool is left out for the same reason (see the constructors).
+        if (session.deterministic()) {
+            aiBudget.hardTime = std::chrono::milliseconds(0);
+            aiBudget.hardNodes = 200000;
+            aiBudget.expertTime = std::chrono::milliseconds(0);
+            aiBudget.expertPlayouts = 20000;
+        }
+    }
+    
+    // Function to prewarm the glyphs of every character size and style the UI uses; returns the time taken in ms
+    double prewarmUIGlyphs() const {
+        std::vector<GlyphSet> sets = {
+            {&font, 28, false, UI_CHARACTERS},       // buttons
+            {&font, 24, false, UI_CHARACTERS},       // status, subtitle, statistics
+            {&font, 20, false, UI_CHARACTERS},       // difficulty
+            {&font, 18, false, UI_CHARACTERS},       // stats line, AI info, back hint
+            {&font, 14, false, UI_CHARACTERS},       // F3 overlay
+            {&titleFont, 60, true, UI_CHARACTERS},   // title
+            {&titleFont, 36, false, UI_CHARACTERS}   // screen titles
+        };
+        // The X and O marks at the size of every board
+        for (int i = 0; i < VARIANT_COUNT; i++) sets.push_back({&font, markSize(VARIANTS[i].size), false, "XO"});
+        return prewarmGlyphs(sets.data(), sets.size());
+    }
+    // Character size of the X and O marks on an n x n board
+    static unsigned markSize(int n) { return static_cast<unsigned>(300.0f / n * 0.48f); }
+
+    // Function to update the background gradient based on animation time
+    void updateBackgroundGradient() {
+        float t = sin(animationTime * 0.5f) * 0.5f + 0.5f;
+        sf::Color topColor(20 + t * 10, 20 + t * 10, 30 + t * 20);
+        sf::Color bottomColor(10 + t * 5, 10 + t * 5, 20 + t * 10);
+        
+        backgroundGradient[0].color = topColor;
+        backgroundGradient[1].color = topColor;
+        backgroundGradient[2].color = bottomColor;
+        backgroundGradient[3].color = bottomColor;
+    }
+    //  Function to initialize the game state
+    void initializeGame() {
+        cancelAIMove();
+        match.reset();
+        lastSearch = SearchResult();
+        aiInfo.clear();
+        dirty |= DIRTY_BOARD | DIRTY_STATUS | DIRTY_AI_INFO;
+    }
+    // Function to initialize the UI elements
+    void initializeUI() {
+        menuButtons[0] = new Button(300, 200, 200, 60, "Play Game", &font, &sounds);
+        menuButtons[1] = new Button(300, 280, 200, 60, "Statistics", &font, &sounds);
+        menuButtons[2] = new Button(300, 360, 200, 60, "Settings", &font, &sounds);
+        menuButtons[3] = new Button(300, 440, 200, 60, "Exit", &font, &sounds);
+        
+        // Mode buttons stacked vertically
+        modeButtons[0] = new Button(300, 250, 200, 60, "Player vs Player", &font, &sounds);
+        modeButtons[1] = new Button(300, 320, 200, 60, "Player vs AI", &font, &sounds);
+        modeButtons[2] = new Button(300, 390, 200, 60, std::string("Board: ") + VARIANTS[match.variantIndex()].name, &font, &sounds);
+        
+        // Game over buttons stacked vertically
+        gameOverButtons[0] = new Button(450, 450, 200, 60, "Play Again", &font, &sounds);
+        gameOverButtons[1] = new Button(450, 520, 200, 60, "Main Menu", &font, &sounds);
+        
+        titleText.setFont(titleFont);
+        titleText.setString("TIC-TAC-TOE");
+        titleText.setCharacterSize(60);
+        titleText.setFillColor(sf::Color(200, 200, 255));
+        titleText.setPosition(150, 80);
+        titleText.setStyle(sf::Text::Bold);
+        // Set the title text to pulse
+        statusText.setFont(font);
+        statusText.setCharacterSize(24);
+        statusText.setFillColor(sf::Color::White);
+        statusText.setPosition(50, 50);
+        // Set the status text to pulse
+        statsText.setFont(font);
+        statsText.setCharacterSize(18);
+        statsText.setFillColor(sf::Color(200, 200, 255));
+        statsText.setPosition(50, 520);
+        // Set the search info text below the status
+        searchInfoText.setFont(font);
+        searchInfoText.setCharacterSize(18);
+        searchInfoText.setFillColor(sf::Color(150, 150, 255));
+        searchInfoText.setPosition(50, 85);
+        // Set up the text of the other screens
+        subtitleText.setFont(font);
+        subtitleText.setString("MASTER EDITION");
+        subtitleText.setCharacterSize(24);
+        subtitleText.setFillColor(sf::Color(150, 150, 255, 200));
+        subtitleText.setPosition(250, 140);
+        
+        difficultyText.setFont(font);
+        difficultyText.setCharacterSize(20);
+        difficultyText.setFillColor(sf::Color(150, 150, 255));
+        difficultyText.setPosition(50, 550);
+        
+        modeTitleText.setFont(titleFont);
+        modeTitleText.setString("Select Game Mode");
+        modeTitleText.setCharacterSize(36);
+        modeTitleText.setFillColor(sf::Color(200, 200, 255));
+        modeTitleText.setPosition(250, 150);
+        
+        settingsTitleText.setFont(titleFont);
+        settingsTitleText.setString("Statistics");
+        settingsTitleText.setCharacterSize(36);
+        settingsTitleText.setFillColor(sf::Color(200, 200, 255));
+        settingsTitleText.setPosition(300, 150);
+        
+        statsDisplayText.setFont(font);
+        statsDisplayText.setCharacterSize(24);
+        statsDisplayText.setFillColor(sf::Color(200, 200, 255));
+        statsDisplayText.setPosition(250, 250);
+        
+        backText.setFont(font);
+        backText.setString("Press ESC to return to menu");
+        backText.setCharacterSize(18);
+        backText.setFillColor(sf::Color(150, 150, 255));
+        backText.setPosition(250, 450);
+        
+        overlayText.setFont(font);
+        overlayText.setCharacterSize(14);
+        overlayText.setFillColor(sf::Color(255, 255, 150));
+        overlayText.setPosition(520, 5);
+        // Static text and the board are drawn from a cached layer when a render texture is available
+        layerCached = staticLayer.create(800, 600);
+        if (layerCached) staticLayerSprite.setTexture(staticLayer.getTexture());
+        setupGrid();
+    }
+    // Function to set up the grid lines and cells for the current board size
+    void setupGrid() {
+        int n = match.position().size();
+        // The board always covers the same 300x300 area; 5px lines on the classic 3x3 board
+        cellPitch = 300.0f / n;
+        cellGap = std::max(1.0f, std::floor(15.0f / n));
+        
+        gridLines.assign(2 * (n - 1), sf::RectangleShape());
+        for (size_t i = 0; i < gridLines.size(); i++) {
+            gridLines[i].setFillColor(sf::Color(200, 200, 255, 200));
+        }
+        for (int k = 1; k < n; k++) {
+            // Vertical line
+            gridLines[2 * k - 2].setPosition(250 + k * cellPitch, 150);
+            gridLines[2 * k - 2].setSize(sf::Vector2f(cellGap, 300));
+            // Horizontal line
+            gridLines[2 * k - 1].setPosition(250, 150 + k * cellPitch);
+            gridLines[2 * k - 1].setSize(sf::Vector2f(300, cellGap));
+        }
+        // Initialize cells and texts
+        cells.assign(n * n, sf::RectangleShape());
+        cellTexts.assign(n * n, sf::Text());
+        float cellSize = cellPitch - cellGap;
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                int cell = i * n + j;
+                sf::Vector2f origin = cellPosition(i, j);
+                cells[cell].setSize(sf::Vector2f(cellSize, cellSize));
+                cells[cell].setPosition(origin);
+                cells[cell].setFillColor(sf::Color(30, 30, 50));
+                cells[cell].setOutlineThickness(cellGap >= 2 ? 2 : 1);
+                cells[cell].setOutlineColor(sf::Color(200, 200, 255, 200));
+                
+                cellTexts[cell].setFont(font);
+                cellTexts[cell].setCharacterSize(markSize(n));
+                cellTexts[cell].setFillColor(sf::Color(200, 200, 255));
+                cellTexts[cell].setPosition(origin.x + cellPitch * 0.25f, origin.y + cellPitch * 0.15f);
+            }
+        }
+        // Highlight drawn over the empty cell under the mouse
+        hoverCell.setSize(sf::Vector2f(cellSize, cellSize));
+        hoverCell.setFillColor(sf::Color(50, 50, 80));
+        hoverCell.setOutlineThickness(cellGap >= 2 ? 2 : 1);
+        hoverCell.setOutlineColor(sf::Color(200, 200, 255, 200));
+        dirty |= DIRTY_BOARD;
+    }
+    // Function to get the top-left corner of a cell on screen
+    sf::Vector2f cellPosition(int row, int col) {
+        return sf::Vector2f(250 + cellGap + col * cellPitch, 150 + cellGap + row * cellPitch);
+    }
+    // Function to switch to another board size
+    void selectVariant(int index) {
+        cancelAIMove();
+        match.selectVariant(index);
+        modeButtons[2]->setLabel(std::string("Board: ") + VARIANTS[index].name);
+        setupGrid();
+        initializeGame();
+    }
+    // Function to take this frame's input snapshot (the mouse is never over the UI when headless)
+    void captureInput() {
+        // A replay sets the snapshot from the recording, step by step
+        if (replay.isOpen()) return;
+        if (offscreen) {
+            input.mouse = sf::Vector2i(-1, -1);
+            input.mouseDown = false;
+            input.escapeDown = false;
+        } else {
+            input.mouse = sf::Mouse::getPosition(window);
+            input.mouseDown = sf::Mouse::isButtonPressed(sf::Mouse::Left);
+            input.escapeDown = sf::Keyboard::isKeyPressed(sf::Keyboard::Escape);
+        }
+        std::uint8_t buttons = (input.mouseDown ? INPUT_MOUSE_DOWN : 0) | (input.escapeDown ? INPUT_ESCAPE_DOWN : 0);
+        if (recorder.isOpen() && (input.mouse != recordedMouse || buttons != recordedButtons)) {
+            recorder.add(simStep, INPUT_STATE, input.mouse.x, input.mouse.y, buttons);
+            recordedMouse = input.mouse;
+            recordedButtons = buttons;
+        }
+    }
+    // Function to find the board cell under a point from the grid geometry (-1 for none or a grid line)
+    int cellAt(sf::Vector2i point) const {
+        float x = point.x - 250.0f;
+        float y = point.y - 150.0f;
+        if (x < 0 || y < 0 || x >= 300.0f || y >= 300.0f) return -1;
+        int n = match.position().size();
+        int col = std::min(static_cast<int>(x / cellPitch), n - 1);
+        int row = std::min(static_cast<int>(y / cellPitch), n - 1);
+        // Each pitch starts with the grid line (or the board edge) before the cell itself
+        if (x - col * cellPitch < cellGap || y - row * cellPitch < cellGap) return -1;
+        return row * n + col;
+    }
+    // Function to start a new game in the given mode
+    void startGame(GameMode mode) {
+        currentMode = mode;
+        currentState = PLAYING;
+        initializeGame();
+    }
+    // Function to handle user input waiting in the event queue
+    void handleInput() {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            handleEvent(event);
+        }
+        captureInput();
+    }
+    // Function to handle one window event
+    void handleEvent(const sf::Event& event) {
+        pacer.noteActivity();
+        // Clicks and key presses are timed until the frame that shows their effect is presented
+        if ((event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::MouseButtonReleased ||
+             event.type == sf::Event::KeyPressed) && !input.awaitingPresent) {
+            input.awaitingPresent = true;
+            input.inputTime = std::chrono::steady_clock::now();
+        }
+        if (event.type == sf::Event::Closed) {
+            cancelAIMove();
+            window.close();
+        }
+        // F3 toggles the frame timing overlay, F4 starts and stops a trace
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) {
+            toggleOverlay();
+        }
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F4) {
+            toggleTrace("frame_trace.json");
+        }
+        // What reaches the simulation is recorded; a replay takes it from the recording instead
+        if (replay.isOpen()) return;
+        if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+            recorder.add(simStep, INPUT_ESCAPE);
+            pressEscape();
+        }
+        if (event.type == sf::Event::MouseButtonPressed) {
+            recorder.add(simStep, INPUT_CLICK, event.mouseButton.x, event.mouseButton.y);
+            pressMouse(sf::Vector2i(event.mouseButton.x, event.mouseButton.y));
+        }
+    }
+    // Function to handle the Escape key: leave a game for the menu
+    void pressEscape() {
+        if (currentState == PLAYING) {
+            cancelAIMove();
+            currentState = MENU;
+        }
+    }
+    // Function to handle a mouse button going down
+    void pressMouse(sf::Vector2i point) {
+        if (currentState == PLAYING && !match.isOver() && !aiThinking) {
+            handleGameClick(point);
+        }
+    }
+    //  Function to handle mouse clicks in the game
+    void handleGameClick(sf::Vector2i mousePos) {
+        int cell = cellAt(mousePos);
+        if (cell != -1 && match.position().isEmpty(cell)) {
+            int n = match.position().size();
+            makeMove(cell / n, cell % n);
+        }
+    }
+    // Function to make a move in the game
+    void makeMove(int row, int col) {
+        int cell = row * match.position().size() + col;
+        if (!match.position().isEmpty(cell) || match.isOver()) return;
+        
+        // Create particles at the cell position in the colour of the player moving
+        float halfCell = (cellPitch - cellGap) / 2;
+        sf::Vector2f origin = cellPosition(row, col);
+        createParticles(sf::Vector2f(origin.x + halfCell, origin.y + halfCell));
+        // O's move sounds a little lower than X's
+        sounds.play(SOUND_MOVE, match.currentPlayer() == 1 ? 1.0f : 0.8f);
+        match.play(cell);
+        dirty |= DIRTY_BOARD | DIRTY_STATUS;
+        // Check for win or draw conditions
+        if (match.isOver()) {
+            createCelebration();
+            updateStats();
+        } else if (currentMode == PLAYER_VS_AI && match.currentPlayer() == 2) {
+            makeAIMove();
+        }
+    }
+    // Function to start computing the AI move on a worker thread
+    void makeAIMove() {
+        cancelAIMove();
+        aiAbort = false;
+        aiThinking = true;
+        // Random draws happen here so the worker never touches the AI's random stream
+        int difficulty = aiDifficulty;
+        unsigned seed = static_cast<unsigned>(aiRandom.next());
+        unsigned randomValue = static_cast<unsigned>(aiRandom.next());
+        GameVariant* position = &match.position();
+        CellState side = match.currentPiece();
+        AIBudget budget = aiBudget;
+        const Tablebase* tablebase = &tablebases[match.variantIndex()];
+        pendingAIMove = std::async(std::launch::async, [this, position, side, difficulty, budget, seed, randomValue, tablebase]() {
+            ProfileScope scope(profiler, FrameProfiler::AI_MOVE);
+            return chooseAIMove(*position, side, difficulty, budget, seed, randomValue, &aiAbort, &openingBook, tablebase);
+        });
+    }
+    // Function to apply the AI move once the worker has finished. A replay applies it on the
+    // step the recording says it arrived on, waiting for the worker if it is not done yet.
+    void pollAIMove() {
+        if (!aiThinking) return;
+        int recordedCell = -1;
+        if (replay.isOpen()) {
+            const InputRecord* record = replay.peek(simStep);
+            if (!record || record->type != INPUT_AI_MOVE || record->step != simStep) return;
+            recordedCell = record->x;
+            replay.advance();
+            pendingAIMove.wait();
+        } else if (pendingAIMove.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return;
+        }
+        AIMove move = pendingAIMove.get();
+        aiThinking = false;
+        if (replay.isOpen() && move.cell != recordedCell) {
+            std::cerr << "Replay: the AI played cell " << move.cell << " at step " << simStep << ", the recording has "
+                      << recordedCell << std::endl;
+            replayDiverged = true;
+        }
+        recorder.add(simStep, INPUT_AI_MOVE, move.cell);
+        if (move.endgame.cell != -1) {
+            aiInfo = std::string("AI: endgame tablebase | ") +
+                     (move.endgame.value == TB_DRAW ? std::string("draw")
+                      : (move.endgame.value == TB_WIN ? "wins" : "loses") + std::string(" in ") + std::to_string(move.endgame.distance) + " plies");
+        } else if (move.book.cell != -1) {
+            aiInfo = "AI: opening book | " + std::to_string(move.book.games) + " games | " +
+                     std::to_string(static_cast<int>(move.book.score * 100 + 0.5)) + "% score";
+        } else if (move.search.bestCell != -1) {
+            lastSearch = move.search;
+            aiInfo = lastSearch.nodes == 0 ? "AI: solved position (table lookup)"
+                   : "AI: " + std::to_string(lastSearch.nodes) + " nodes | depth " + std::to_string(lastSearch.depth) +
+                     " | " + std::to_string(static_cast<int>(lastSearch.elapsedMs)) + " ms | " +
+                     std::to_string(match.position().searchThreads()) + " threads | TT " +
+                     std::to_string(static_cast<int>(lastSearch.table.hitRate() * 100 + 0.5)) + "% hits";
+        } else if (move.mcts.bestCell != -1) {
+            aiInfo = "AI: " + std::to_string(move.mcts.playouts) + " playouts | " +
+                     std::to_string(static_cast<int>(move.mcts.playoutsPerSecond)) + " playouts/s | " +
+                     std::to_string(move.mcts.threads) + " threads";
+        }
+        dirty |= DIRTY_AI_INFO;
+        // Make the best move if found
+        if (move.cell != -1) {
+            makeMove(move.cell / match.position().size(), move.cell % match.position().size());
+        }
+    }
+    // Function to abort a running AI search and discard its result
+    void cancelAIMove() {
+        if (!aiThinking) return;
+        aiAbort = true;
+        pendingAIMove.wait();
+        pendingAIMove = std::future<AIMove>();
+        aiThinking = false;
+    }
+    // Function to create particles for visual effects
+    void createParticles(sf::Vector2f position) {
+        std::uint32_t color = (match.currentPlayer() == 1) ? 0xFF6464 : 0x6464FF;
+        for (int i = 0; i < 20; i++) {
+            float angle = static_cast<float>(particleRandom.nextBelow(360)) * 3.14159f / 180.0f;
+            float speed = static_cast<float>(particleRandom.nextBelow(100) + 50);
+            particles.spawn(position.x, position.y, cos(angle) * speed, sin(angle) * speed, color, 2.0f);
+        }
+    }
+    // Function to burst particles over the whole board when a game ends (both colours for a draw)
+    void createCelebration() {
+        const int CELEBRATION_PARTICLES = 20000;
+        int winner = match.winner();
+        for (int i = 0; i < CELEBRATION_PARTICLES; i++) {
+            float angle = static_cast<float>(particleRandom.nextBelow(3600)) * 3.14159f / 1800.0f;
+            float speed = static_cast<float>(particleRandom.nextBelow(300) + 30);
+            bool red = (winner == 1) || (winner == 0 && i % 2 == 0);
+            particles.spawn(400, 300, cos(angle) * speed, sin(angle) * speed, red ? 0xFF6464 : 0x6464FF,
+                            1.5f + static_cast<float>(particleRandom.nextBelow(100)) / 100.0f);
+        }
+    }
+    // Function to update game statistics; the game goes to the journal as soon as it ends
+    void updateStats() {
+        recordResult(stats, match.winner(), currentMode);
+        // The win jingle drops in pitch when the AI is the one winning
+        if (match.winner() == 0) sounds.play(SOUND_DRAW);
+        else sounds.play(SOUND_WIN, (currentMode == PLAYER_VS_AI && match.winner() == 2) ? 0.75f : 1.0f);
+        if (journal.isOpen()) {
+            journal.append(currentMode, aiDifficulty, match.variantIndex(), match.winner(), match.moves());
+        }
+        dirty |= DIRTY_STATS;
+    }
+    // Function to save game statistics (only the text file needs it; the journal is already up to date)
+    void saveStats() {
+        if (journal.isOpen()) {
+            journal.flush();
+        } else {
+            ::saveStats(stats, "game_stats.txt");
+        }
+    }
+    // Function to load game statistics from the journal, importing the old text file into a new one
+    void loadStats() {
+        if (journal.open("match_history.bin")) {
+            GameStats legacy;
+            if (journal.size() == 0 && ::loadStats(legacy, "game_stats.txt")) journal.importLegacy(legacy);
+            stats = journal.stats();
+        } else {
+            std::cerr << "Warning: Could not open match_history.bin, keeping statistics in game_stats.txt" << std::endl;
+            ::loadStats(stats, "game_stats.txt");
+        }
+        dirty |= DIRTY_STATS;
+    }
+    // Function to update the game state
+    void update(float deltaTime) {
+        animationTime += deltaTime;
+        pollAIMove();
+        updateBackgroundGradient();
+        // Update particles
+        particles.update(deltaTime);
+        updateOverlay(deltaTime);
+        
+        sf::Vector2i mousePos = input.mouse;
+        bool mousePressed = input.mouseDown;
+        
+        if (currentState == MENU) {
+            for (int i = 0; i < 4; i++) {
+                menuButtons[i]->update(mousePos, mousePressed, deltaTime);
+                if (menuButtons[i]->isClicked()) {
+                    switch (i) {
+                        case 0: currentState = MODE_SELECT; break;
+                        case 1: currentState = SETTINGS; break;
+                        case 2:
+                            aiDifficulty = (aiDifficulty % DIFFICULTY_COUNT) + 1;
+                            dirty |= DIRTY_DIFFICULTY;
+                            break;
+                        case 3: window.close(); break;
+                    }
+                }
+            }
+        } else if (currentState == MODE_SELECT) {
+            for (int i = 0; i < 3; i++) {
+                modeButtons[i]->update(mousePos, mousePressed, deltaTime);
+                if (modeButtons[i]->isClicked()) {
+                    if (i == 2) {
+                        selectVariant((match.variantIndex() + 1) % VARIANT_COUNT);
+                    } else {
+                        startGame((i == 0) ? PLAYER_VS_PLAYER : PLAYER_VS_AI);
+                    }
+                }
+            }
+        } else if (currentState == PLAYING && match.isOver()) {
+            for (int i = 0; i < 2; i++) {
+                gameOverButtons[i]->update(mousePos, mousePressed, deltaTime);
+                if (gameOverButtons[i]->isClicked()) {
+                    if (i == 0) {
+                        initializeGame();
+                    } else {
+                        currentState = MENU;
+                    }
+                }
+            }
+        } else if (currentState == SETTINGS && input.escapeDown) {
+            currentState = MENU;
+        }
+    }
+    // Function to advance the simulation by one fixed step, feeding it the recorded input when replaying
+    void stepSimulation() {
+        if (replay.isOpen()) applyRecordedInput();
+        if (replayDone) return;
+        update(SIM_STEP);
+        simStep++;
+    }
+    // Function to apply the recorded events and mouse state of the current step; the AI move
+    // of the step is left for pollAIMove
+    void applyRecordedInput() {
+        while (const InputRecord* record = replay.peek(simStep)) {
+            if (record->step < simStep) {
+                // An AI move that never arrived: the replay has already gone its own way
+                std::cerr << "Replay: nothing to apply the recorded AI move of step " << record->step << " to" << std::endl;
+                replayDiverged = true;
+                replay.advance();
+                continue;
+            }
+            if (record->type == INPUT_AI_MOVE) return;
+            if (record->type == INPUT_END) {
+                finishReplay();
+                return;
+            }
+            InputRecord event = *record;
+            replay.advance();
+            if (event.type == INPUT_STATE) {
+                input.mouse = sf::Vector2i(event.x, event.y);
+                input.mouseDown = (event.flags & INPUT_MOUSE_DOWN) != 0;
+                input.escapeDown = (event.flags & INPUT_ESCAPE_DOWN) != 0;
+            } else if (event.type == INPUT_CLICK) {
+                pressMouse(sf::Vector2i(event.x, event.y));
+            } else if (event.type == INPUT_ESCAPE) {
+                pressEscape();
+            }
+        }
+        // A recording cut short ends where its records do
+        if (replay.finished()) finishReplay();
+    }
+    // Function to end a replay and compare the simulation state with the recorded one
+    void finishReplay() {
+        if (replayDone) return;
+        replayDone = true;
+        replayMatched = !replayDiverged && simulationChecksum() == replay.expectedChecksum();
+        if (!offscreen) {
+            std::cout << "Replay " << (replayMatched ? "matched" : "did not match") << " the recording after "
+                      << simStep << " steps" << std::endl;
+        }
+    }
+    // Function to close the recording with the checksum of the state it ends in
+    void finishRecording() {
+        if (!recorder.isOpen()) return;
+        long long records = recorder.written();
+        if (recorder.finish(simStep, simulationChecksum())) {
+            std::cout << "Recorded " << simStep << " steps (" << records << " inputs) to " << session.recordPath
+                      << ", seed " << sessionSeed << std::endl;
+        } else {
+            std::cerr << "Warning: Could not finish writing " << session.recordPath << std::endl;
+        }
+    }
+    // Function to hash the simulation state: the step, the screen and settings, the game, every
+    // particle and both random streams. A replay that ends on the same hash ran the same steps.
+    std::uint64_t simulationChecksum() const {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        auto add = [&hash](std::uint64_t value) { hash = (hash ^ value) * 0x100000001B3ull; };
+        auto addFloats = [&add](const float* values, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                std::uint32_t bits;
+                std::memcpy(&bits, &values[i], sizeof(bits));
+                add(bits);
+            }
+        };
+        add(simStep);
+        add(currentState);
+        add(currentMode);
+        add(aiDifficulty);
+        add(match.variantIndex());
+        add(match.winner());
+        for (int cell : match.moves()) add(static_cast<std::uint64_t>(cell));
+        add(particles.size());
+        addFloats(particles.positionsX(), particles.size());
+        addFloats(particles.positionsY(), particles.size());
+        addFloats(&animationTime, 1);
+        add(aiRandom.fingerprint());
+        add(particleRandom.fingerprint());
+        return hash;
+    }
+    // Function to replay the whole recording without pacing, drawing a frame every other step
+    // (60 frames a second of simulated time); returns the number of frames drawn
+    long long runReplay() {
+        long long frames = 0;
+        while (replay.isOpen() && !replayDone) {
+            stepSimulation();
+            if (simStep % 2 == 0) {
+                render();
+                frames++;
+            }
+        }
+        return frames;
+    }
+    bool replaying() const { return replay.isOpen(); }
+    bool replayFinished() const { return replayDone; }
+    bool replaySucceeded() const { return replayMatched; }
+    std::uint32_t simulationSteps() const { return simStep; }
+    // Function to rebuild the strings that changed and redraw the cached static layer
+    void refreshUI() {
+        if (dirty == 0 && layerValid && layerState == currentState) return;
+        if (dirty & DIRTY_BOARD) refreshBoardText();
+        if (dirty & DIRTY_STATUS) refreshStatusText();
+        if (dirty & DIRTY_STATS) refreshStatsText();
+        if (dirty & DIRTY_DIFFICULTY) difficultyText.setString(std::string("AI Difficulty: ") + difficultyName(aiDifficulty));
+        if (dirty & DIRTY_AI_INFO) searchInfoText.setString(aiInfo);
+        dirty = 0;
+        layerValid = true;
+        layerState = currentState;
+        if (layerCached) {
+            staticLayer.clear(sf::Color::Transparent);
+            drawStaticLayer(staticLayer);
+            staticLayer.display();
+        }
+    }
+    // Function to set the X and O marks from the board
+    void refreshBoardText() {
+        for (int cell = 0; cell < match.position().cellCount(); cell++) {
+            CellState cellState = match.position().at(cell);
+            if (cellState == X_PLAYER) {
+                cellTexts[cell].setString("X");
+                cellTexts[cell].setFillColor(sf::Color(255, 100, 100));
+            } else if (cellState == O_PLAYER) {
+                cellTexts[cell].setString("O");
+                cellTexts[cell].setFillColor(sf::Color(100, 100, 255));
+            }
+        }
+    }
+    // Function to set the turn or result line
+    void refreshStatusText() {
+        if (match.isOver()) {
+            if (match.winner() == 1) {
+                statusText.setString("Player X Wins!");
+                statusText.setFillColor(sf::Color(255, 100, 100));
+            } else if (match.winner() == 2) {
+                if (currentMode == PLAYER_VS_AI) {
+                    statusText.setString("AI Wins!");
+                    statusText.setFillColor(sf::Color(100, 100, 255));
+                } else {
+                    statusText.setString("Player O Wins!");
+                    statusText.setFillColor(sf::Color(100, 100, 255));
+                }
+            } else {
+                statusText.setString("It's a Draw!");
+                statusText.setFillColor(sf::Color(150, 150, 255));
+            }
+        } else {
+            if (currentMode == PLAYER_VS_AI) {
+                statusText.setString((match.currentPlayer() == 1) ? "Your Turn (X)" : "AI Thinking...");
+            } else {
+                statusText.setString((match.currentPlayer() == 1) ? "Player X Turn" : "Player O Turn");
+            }
+            statusText.setFillColor(sf::Color(200, 200, 255));
+        }
+    }
+    // Function to set the statistics lines of the game and statistics screens
+    void refreshStatsText() {
+         std::string statsString = "Games: " +  std::to_string(stats.totalGames) + 
+                                 " | Wins: " +  std::to_string(stats.playerWins) + 
+                                 " | AI Wins: " +  std::to_string(stats.aiWins) + 
+                                 " | Draws: " +  std::to_string(stats.draws);
+        statsText.setString(statsString);
+        
+         std::string statsDisplay = "Total Games: " +  std::to_string(stats.totalGames) + "\n" +
+                               "Player Wins: " +  std::to_string(stats.playerWins) + "\n" +
+                               "AI Wins: " +  std::to_string(stats.aiWins) + "\n" +
+                               "Draws: " +  std::to_string(stats.draws);
+        
+        if (stats.totalGames > 0) {
+            float winRate = (float)stats.playerWins / stats.totalGames * 100;
+            statsDisplay += "\nWin Rate: " +  std::to_string(static_cast<int>(winRate)) + "%";
+        }
+        statsDisplayText.setString(statsDisplay);
+    }
+    // Function to draw everything on the current screen that does not animate
+    void drawStaticLayer(sf::RenderTarget& layer) {
+        if (currentState == MENU) {
+            layer.draw(subtitleText);
+            layer.draw(difficultyText);
+        } else if (currentState == MODE_SELECT) {
+            layer.draw(modeTitleText);
+        } else if (currentState == PLAYING) {
+            for (size_t i = 0; i < gridLines.size(); i++) {
+                layer.draw(gridLines[i]);
+            }
+            for (int cell = 0; cell < match.position().cellCount(); cell++) {
+                layer.draw(cells[cell]);
+                if (!match.position().isEmpty(cell)) layer.draw(cellTexts[cell]);
+            }
+            layer.draw(statusText);
+            layer.draw(statsText);
+            // Draw the statistics of the last AI search
+            if (currentMode == PLAYER_VS_AI && !aiInfo.empty()) {
+                layer.draw(searchInfoText);
+            }
+        } else if (currentState == SETTINGS) {
+            layer.draw(settingsTitleText);
+            layer.draw(statsDisplayText);
+            layer.draw(backText);
+        }
+    }
+    // Function to show or hide the frame timing overlay
+    void toggleOverlay() {
+        profiler.setTiming(!profiler.isTiming());
+        overlayRefresh = 0;
+        overlayText.setString("");
+    }
+    // Function to start a trace, or stop the running one and write it to path
+    void toggleTrace(const std::string& path) {
+        if (!profiler.isTracing()) {
+            profiler.startTrace();
+            std::cout << "Trace started" << std::endl;
+        } else {
+            std::size_t count = profiler.traceEventCount();
+            if (profiler.stopTrace(path)) {
+                std::cout << "Trace of " << count << " events written to " << path << std::endl;
+            } else {
+                std::cerr << "Could not write trace to " << path << std::endl;
+            }
+        }
+    }
+    // Function to rebuild the overlay text a few times a second rather than every frame
+    void updateOverlay(float deltaTime) {
+        if (!profiler.isTiming()) return;
+        overlayRefresh -= deltaTime;
+        if (overlayRefresh > 0) return;
+        overlayRefresh = 0.25f;
+        SampleWindow::Summary summary = profiler.summarize();
+        SampleWindow::Summary latency = profiler.summarizeInputLatency();
+        char line[320];
+        std::snprintf(line, sizeof(line),
+                      "frame p50 %.2f  p99 %.2f  max %.2f ms\n"
+                      "input to present p50 %.1f  max %.1f ms\n"
+                      "input %.2f  update %.2f  render %.2f\n"
+                      "present %.2f  ai move %.1f ms\n"
+                      "startup %.0f ms  glyph warm-up %.1f ms%s",
+                      summary.p50Ms, summary.p99Ms, summary.maxMs, latency.p50Ms, latency.maxMs,
+                      profiler.lastMs(FrameProfiler::INPUT), profiler.lastMs(FrameProfiler::UPDATE),
+                      profiler.lastMs(FrameProfiler::RENDER), profiler.lastMs(FrameProfiler::PRESENT),
+                      profiler.lastMs(FrameProfiler::AI_MOVE), startupMs, glyphWarmupMs,
+                      profiler.isTracing() ? "\ntracing" : "");
+        overlayText.setString(line);
+    }
+    // Function to render the game on the window (or the offscreen texture)
+    void render() {
+        drawFrame();
+        present();
+    }
+    // Function to draw a frame without presenting it
+    void drawFrame() {
+        target->clear();
+        target->draw(backgroundGradient);
+        // Everything that only changes with the game state comes from the cached layer in one draw call;
+        // its texture holds premultiplied colour, hence the blend mode
+        refreshUI();
+        if (layerCached) {
+            target->draw(staticLayerSprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha)));
+        } else {
+            drawStaticLayer(*target);
+        }
+        // Then only what animates
+        if (currentState == MENU) {
+            renderMenu();
+        } else if (currentState == MODE_SELECT) {
+            renderModeSelect();
+        } else if (currentState == PLAYING) {
+            renderGame();
+        }
+        
+        particleRenderer.draw(*target, particles, renderLead);
+        if (profiler.isTiming()) target->draw(overlayText);
+    }
+    // Function to show the drawn frame (this is where the frame rate cap waits)
+    void present() {
+        if (offscreen) {
+            offscreen->display();
+        } else {
+            window.display();
+        }
+        if (input.awaitingPresent) {
+            profiler.recordInputLatency(std::chrono::steady_clock::now() - input.inputTime);
+            input.awaitingPresent = false;
+        }
+        if (!firstFramePresented) {
+            firstFramePresented = true;
+            startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - constructedAt).count();
+            if (!offscreen) {
+                std::cout << "Startup: first frame after " << startupMs << " ms (glyphs prewarmed off-thread in "
+                          << glyphWarmupMs << " ms)" << std::endl;
+            }
+        }
+    }
+    // Function to render the animated parts of the menu
+    void renderMenu() {
+        float time = animationTime + renderLead;
+        float scale = 1.0f + sin(time * 2.0f) * 0.05f;
+        titleText.setScale(scale, scale);
+        titleText.setFillColor(sf::Color(200 + sin(time) * 55, 200 + sin(time * 0.7f) * 55,255));
+        target->draw(titleText);
+        
+        for (int i = 0; i < 4; i++) {
+            menuButtons[i]->draw(*target);
+        }
+    }
+    // Function to render the mode selection buttons
+    void renderModeSelect() {
+        // Draw mode buttons vertically
+        modeButtons[0]->draw(*target);
+        modeButtons[1]->draw(*target);
+        modeButtons[2]->draw(*target);
+    }
+    // Function to render the animated parts of the game screen
+    void renderGame() {
+        if (match.isOver()) {
+            // Draw game over buttons vertically
+            gameOverButtons[0]->draw(*target);
+            gameOverButtons[1]->draw(*target);
+            return;
+        }
+        // Highlight the empty cell under the mouse
+        int cell = cellAt(input.mouse);
+        if (cell != -1 && match.position().isEmpty(cell)) {
+            hoverCell.setPosition(cells[cell].getPosition());
+            target->draw(hoverCell);
+        }
+    }
+    // Function to check whether anything on screen would change without further input
+    bool isAnimating() {
+        // A replay's input does not arrive as events, so it never waits for one
+        if (replay.isOpen() && !replayDone) return true;
+        if (!particles.empty() || aiThinking || pacer.ambientActive()) return true;
+        if (currentState == MENU) {
+            for (int i = 0; i < 4; i++) {
+                if (menuButtons[i]->isAnimating()) return true;
+            }
+        } else if (currentState == MODE_SELECT) {
+            for (int i = 0; i < 3; i++) {
+                if (modeButtons[i]->isAnimating()) return true;
+            }
+        } else if (currentState == PLAYING && match.isOver()) {
+            for (int i = 0; i < 2; i++) {
+                if (gameOverButtons[i]->isAnimating()) return true;
+            }
+        }
+        return false;
+    }
+    // Function to run the game loop. Frames run at the frame rate cap while anything animates;
+    // once everything has settled the loop blocks until the next event instead of redrawing
+    // an unchanged frame, and picks up full rate again from there.
+    //
+    // The simulation is decoupled from the frame rate: each frame runs as many SIM_STEP steps
+    // as the real time since the last frame covers, and the remainder carries over. Frames
+    // draw what moves (particles, the title pulse) that remainder ahead of the last step, so
+    // motion stays smooth when the frame and step rates do not line up.
+    void run() {
+        sf::Clock clock;
+        float accumulator = 0;
+        while (window.isOpen() && !replayDone) {
+            if (!isAnimating()) {
+                sf::Event event;
+                pacer.beginIdle();
+                bool woken = window.waitEvent(event);
+                pacer.endIdle();
+                if (!woken) break;
+                handleEvent(event);
+                // The time spent waiting is not animation time
+                clock.restart();
+            }
+            accumulator += clock.restart().asSeconds();
+            {
+                ProfileScope frame(profiler, FrameProfiler::FRAME);
+                {
+                    ProfileScope phase(profiler, FrameProfiler::INPUT);
+                    handleInput();
+                }
+                {
+                    ProfileScope phase(profiler, FrameProfiler::UPDATE);
+                    int steps = 0;
+                    while (accumulator >= SIM_STEP && steps < MAX_STEPS_PER_FRAME && !replayDone) {
+                        stepSimulation();
+                        accumulator -= SIM_STEP;
+                        steps++;
+                    }
+                    if (steps == MAX_STEPS_PER_FRAME) accumulator = std::fmod(accumulator, SIM_STEP);
+                    renderLead = accumulator;
+                }
+                {
+                    ProfileScope phase(profiler, FrameProfiler::RENDER);
+                    drawFrame();
+                }
+            }
+            {
+                ProfileScope phase(profiler, FrameProfiler::PRESENT);
+                present();
+            }
+            pacer.frameRendered();
+        }
+        finishRecording();
+        std::cout << "Rendered " << pacer.frameCount() << " frames in " << pacer.elapsedSeconds() << " s, idle "
+                  << static_cast<int>(pacer.idleFraction() * 100 + 0.5) << "% (" << pacer.wakeupCount() << " wake-ups)" << std::endl;
+    }
+};
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "mcts.h"
+#include "opening_book.h"
+#include "search.h"
+#include "tablebase.h"
+#include "thread_pool.h"
+#include "variant.h"
+
+// UI-free game logic shared by the SFML game and the command-line tools:
+// turn order and results, the AI difficulty levels and the statistics file.
+
+// Game Modes
+enum GameMode {
+    PLAYER_VS_PLAYER,
+    PLAYER_VS_AI
+};
+
+// AI difficulty levels, in the order the menu cycles through them
+constexpr int DIFFICULTY_COUNT = 4;
+
+inline const char* difficultyName(int difficulty) {
+    switch (difficulty) {
+        case 1: return "Easy";
+        case 2: return "Medium";
+        case 3: return "Hard";
+        default: return "Expert";
+    }
+}
+
+// Per-move budgets of the levels that search. The game uses wall-clock budgets;
+// batch runs set node and playout counts instead so results do not depend on load.
+struct AIBudget {
+    long long mediumPlayouts = 300;
+    std::chrono::milliseconds hardTime{250};
+    long long hardNodes = 0;
+    std::chrono::milliseconds expertTime{500};
+    long long expertPlayouts = 0;
+};
+
+// Move chosen by the AI, with the statistics of whichever engine (or table) produced it
+struct AIMove {
+    int cell;
+    SearchResult search;
+    MCTSResult mcts;
+    BookMove book;
+    TablebaseMove endgame;
+
+    AIMove() : cell(-1) {}
+};
+
+// Function to pick the AI move for the side to move based on difficulty level.
+// Random values come from the caller so this is safe to run on any thread. The levels
+// that search play perfectly from the endgame tablebase once the position is in it, and
+// otherwise from the opening book first when one is given and knows the position. Boards
+// with a solved table never use the book, whose self-play statistics can only be worse.
+inline AIMove chooseAIMove(GameVariant& position, CellState side, int difficulty, const AIBudget& budget,
+                           unsigned seed, unsigned randomValue, const std::atomic<bool>* abortFlag = nullptr,
+                           const OpeningBook* book = nullptr, const Tablebase* tablebase = nullptr) {
+    AIMove move;
+    if (tablebase && difficulty >= 3) {
+        move.endgame = tablebase->probe(position);
+        if (move.endgame.cell != -1) {
+            move.cell = move.endgame.cell;
+            return move;
+        }
+    }
+    if (book && difficulty >= 3 && !position.hasSolvedTable()) {
+        move.book = book->probe(position);
+        if (move.book.cell != -1) {
+            move.cell = move.book.cell;
+            return move;
+        }
+    }
+
+    if (difficulty == 1) {
+        move.cell = position.randomMove(randomValue);
+    } else if (difficulty == 2) {
+        // Take an immediate win or block, otherwise a small fixed number of MCTS playouts
+        move.cell = position.strategicMove(side);
+        if (move.cell == -1) {
+            MCTSLimits limits;
+            limits.maxPlayouts = budget.mediumPlayouts;
+            limits.seed = seed;
+            limits.abortFlag = abortFlag;
+            move.mcts = position.mctsMove(limits);
+            move.cell = move.mcts.bestCell;
+        }
+    } else if (difficulty == 4) {
+        // MCTS on every available core for a fixed budget per move
+        MCTSLimits limits;
+        limits.timeBudget = budget.expertTime;
+        limits.maxPlayouts = budget.expertPlayouts;
+        limits.seed = seed;
+        limits.abortFlag = abortFlag;
+        move.mcts = position.mctsMove(limits);
+        move.cell = move.mcts.bestCell;
+    } else {
+        // Alpha-beta search under a per-move budget; solved positions come straight from the table
+        SearchLimits limits;
+        limits.timeBudget = budget.hardTime;
+        limits.maxNodes = budget.hardNodes;
+        limits.abortFlag = abortFlag;
+        move.search = position.searchMove(limits);
+        move.cell = move.search.bestCell;
+    }
+    return move;
+}
+
+// One game in progress: the board of the selected variant, whose turn it is and how it ended.
+// Players are numbered 1 (X, moves first) and 2 (O); winner 0 means a draw.
+class Match {
+public:
+    explicit Match(int variantIndex = 0, ThreadPool* pool = nullptr) : searchPool(pool) {
+        selectVariant(variantIndex);
+    }
+
+    // Function to switch to another board size and start a new game on it
+    void selectVariant(int index) {
+        variantIdx = index;
+        variant = createVariant(index);
+        variant->setThreadPool(searchPool);
+        reset();
+    }
+    // Function to start a new game on the current board
+    void reset() {
+        variant->reset();
+        variant->clearSearchHistory();
+        history.clear();
+        player = 1;
+        result = 0;
+        ended = false;
+    }
+
+    // Function to play a cell for the side to move; returns false if the move is not legal
+    bool play(int cell) {
+        if (ended || cell < 0 || cell >= variant->cellCount() || !variant->isEmpty(cell)) return false;
+        history.push_back(cell);
+        if (variant->play(cell, currentPiece())) {
+            result = player;
+            ended = true;
+        } else if (variant->isFull()) {
+            result = 0;
+            ended = true;
+        } else {
+            player = (player == 1) ? 2 : 1;
+        }
+        return true;
+    }
+
+    GameVariant& position() { return *variant; }
+    const GameVariant& position() const { return *variant; }
+    int variantIndex() const { return variantIdx; }
+    int currentPlayer() const { return player; }
+    CellState currentPiece() const { return (player == 1) ? X_PLAYER : O_PLAYER; }
+    int winner() const { return result; }
+    bool isOver() const { return ended; }
+    // Cells played so far, in order
+    const std::vector<int>& moves() const { return history; }
+
+private:
+    ThreadPool* searchPool;
+    std::unique_ptr<GameVariant> variant;
+    int variantIdx = 0;
+    std::vector<int> history;
+    int player = 1;
+    int result = 0;
+    bool ended = false;
+};
+
+// Game statistics structure to keep track of wins, losses, and draws
+struct GameStats {
+    int playerWins;
+    int aiWins;
+    int draws;
+    int totalGames;
+
+    GameStats() : playerWins(0), aiWins(0), draws(0), totalGames(0) {}
+};
+
+// Function to update game statistics with the result of a finished game
+inline void recordResult(GameStats& stats, int winner, GameMode mode) {
+    stats.totalGames++;
+    if (winner == 1) {
+        stats.playerWins++;
+    } else if (winner == 2) {
+        if (mode == PLAYER_VS_AI) {
+            stats.aiWins++;
+        } else {
+            stats.playerWins++;
+        }
+    } else {
+        stats.draws++;
+    }
+}
+
+// Function to save game statistics to a file
+inline bool saveStats(const GameStats& stats, const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    file << stats.playerWins << " " << stats.aiWins << " " << stats.draws << " " << stats.totalGames;
+    return true;
+}
+
+// Function to load game statistics from a file
+inline bool loadStats(GameStats& stats, const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    file >> stats.playerWins >> stats.aiWins >> stats.draws >> stats.totalGames;
+    return true;
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "variant.h"
+
+// Compact archive format for finished games, for analytics and engine training.
+//
+// A file is an 8-byte header ("TTTR", version, board) followed by one record per game.
+// Every game in a file is on the same board.
+//
+//   3x3     one little-endian 32-bit word per game:
+//             bits 0-3   number of moves (0-9)
+//             bits 4-5   winner (0 draw, 1 X, 2 O)
+//             bits 6-24  the moves in mixed radix: move k is stored as its rank among
+//                        the 9 - k cells still empty, so all nine fit in 19 bits
+//   others  a varint of (moves << 2 | winner), then per move a varint of the zig-zag
+//           encoded difference from the previous cell (the first from cell 0).
+//           Play tends to stay local on the big boards, so most moves take one byte.
+//
+// GameRecordWriter and GameRecordReader stream through large buffers with sequential
+// reads and writes and never allocate per record.
+
+// A decoded game; moves[0..moveCount) are cell indices in play order
+struct GameRecord {
+    static constexpr int MAX_MOVES = 15 * 15;
+
+    int winner = 0;
+    int moveCount = 0;
+    int moves[MAX_MOVES];
+};
+
+namespace record_format {
+
+constexpr char MAGIC[4] = {'T', 'T', 'T', 'R'};
+constexpr std::uint8_t VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 8;
+// Largest encoding of one game: a two-byte header and two bytes per move
+constexpr std::size_t MAX_RECORD_BYTES = 2 + 2 * GameRecord::MAX_MOVES;
+
+// Function to pack a 3x3 game into one word
+inline std::uint32_t packSmall(int winner, const int* moves, int count) {
+    std::uint32_t empty = 0x1FF;
+    std::uint32_t sequence = 0;
+    std::uint32_t radix = 1;
+    for (int k = 0; k < count; k++) {
+        std::uint32_t below = empty & ((1u << moves[k]) - 1);
+        sequence += static_cast<std::uint32_t>(__builtin_popcount(below)) * radix;
+        radix *= 9 - k;
+        empty &= ~(1u << moves[k]);
+    }
+    return static_cast<std::uint32_t>(count) | (static_cast<std::uint32_t>(winner) << 4) | (sequence << 6);
+}
+
+// Function to unpack a 3x3 word; returns false if it is not a valid record
+inline bool unpackSmall(std::uint32_t word, GameRecord& record) {
+    record.moveCount = static_cast<int>(word & 0xF);
+    record.winner = static_cast<int>((word >> 4) & 0x3);
+    if (record.moveCount > 9 || record.winner > 2) return false;
+    std::uint32_t sequence = word >> 6;
+    std::uint32_t empty = 0x1FF;
+    for (int k = 0; k < record.moveCount; k++) {
+        std::uint32_t rank = sequence % (9 - k);
+        sequence /= 9 - k;
+        // Select the rank-th empty cell
+        std::uint32_t candidates = empty;
+        for (std::uint32_t skip = 0; skip < rank; skip++) candidates &= candidates - 1;
+        int cell = __builtin_ctz(candidates);
+        record.moves[k] = cell;
+        empty &= ~(1u << cell);
+    }
+    return sequence == 0;
+}
+
+inline std::size_t putVarint(std::uint32_t value, unsigned char* out) {
+    std::size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(value);
+    return n;
+}
+
+// Function to read a varint of at most five bytes; returns the bytes used, 0 if it runs past end
+inline std::size_t getVarint(const unsigned char* in, const unsigned char* end, std::uint32_t& value) {
+    value = 0;
+    for (std::size_t n = 0; n < 5 && in + n < end; n++) {
+        value |= static_cast<std::uint32_t>(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+// Function to encode one game for a board of the given size; out needs MAX_RECORD_BYTES
+inline std::size_t encode(int boardSize, int winner, const int* moves, int count, unsigned char* out) {
+    if (boardSize == 3) {
+        std::uint32_t word = packSmall(winner, moves, count);
+        for (int i = 0; i < 4; i++) out[i] = static_cast<unsigned char>(word >> (8 * i));
+        return 4;
+    }
+    std::size_t n = putVarint(static_cast<std::uint32_t>(count) << 2 | static_cast<std::uint32_t>(winner), out);
+    int previous = 0;
+    for (int k = 0; k < count; k++) {
+        int delta = moves[k] - previous;
+        n += putVarint(static_cast<std::uint32_t>((delta << 1) ^ (delta >> 31)), out + n);
+        previous = moves[k];
+    }
+    return n;
+}
+
+// Function to decode one game; returns the bytes used, 0 if the data is truncated or invalid
+inline std::size_t decode(int boardSize, const unsigned char* in, const unsigned char* end, GameRecord& record) {
+    if (boardSize == 3) {
+        if (end - in < 4) return 0;
+        std::uint32_t word = in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<std::uint32_t>(in[3]) << 24);
+        return unpackSmall(word, record) ? 4 : 0;
+    }
+    std::uint32_t value;
+    std::size_t n = getVarint(in, end, value);
+    if (n == 0) return 0;
+    record.moveCount = static_cast<int>(value >> 2);
+    record.winner = static_cast<int>(value & 0x3);
+    int cells = boardSize * boardSize;
+    if (record.moveCount > cells || record.winner > 2) return 0;
+    int previous = 0;
+    for (int k = 0; k < record.moveCount; k++) {
+        std::size_t used = getVarint(in + n, end, value);
+        if (used == 0) return 0;
+        n += used;
+        int delta = static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+        previous += delta;
+        if (previous < 0 || previous >= cells) return 0;
+        record.moves[k] = previous;
+    }
+    return n;
+}
+
+}  // namespace record_format
+
+// Streams games into a record file
+class GameRecordWriter {
+public:
+    static constexpr std::size_t BUFFER_BYTES = 1 << 20;
+
+    GameRecordWriter() : file(nullptr), boardSize(0), used(0), records(0) {}
+    ~GameRecordWriter() { close(); }
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+    // Function to create (or truncate) a record file for one board; returns false on failure
+    bool open(const std::string& path, int variantIndex) {
+        close();
+        if (variantIndex < 0 || variantIndex >= VARIANT_COUNT) return false;
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        buffer.resize(BUFFER_BYTES);
+        boardSize = VARIANTS[variantIndex].size;
+        unsigned char header[record_format::HEADER_BYTES] = {};
+        std::memcpy(header, record_format::MAGIC, sizeof(record_format::MAGIC));
+        header[4] = record_format::VERSION;
+        header[5] = static_cast<unsigned char>(variantIndex);
+        std::memcpy(buffer.data(), header, sizeof(header));
+        used = sizeof(header);
+        records = 0;
+        return true;
+    }
+
+    // Function to add one game
+    bool append(int winner, const int* moves, int count) {
+        if (!file) return false;
+        if (used + record_format::MAX_RECORD_BYTES > buffer.size() && !flush()) return false;
+        used += record_format::encode(boardSize, winner, moves, count, buffer.data() + used);
+        records++;
+        return true;
+    }
+    bool append(int winner, const std::vector<int>& moves) {
+        return append(winner, moves.data(), static_cast<int>(moves.size()));
+    }
+    // Function to add games already encoded for this board (see record_format::encode)
+    bool appendEncoded(const unsigned char* data, std::size_t bytes, long long games) {
+        if (!file) return false;
+        if (used + bytes > buffer.size() && !flush()) return false;
+        if (bytes > buffer.size()) {
+            if (std::fwrite(data, 1, bytes, file) != bytes) return false;
+        } else {
+            std::memcpy(buffer.data() + used, data, bytes);
+            used += bytes;
+        }
+        records += games;
+        return true;
+    }
+
+    // Function to write out everything buffered so far
+    bool flush() {
+        if (!file) return false;
+        bool ok = std::fwrite(buffer.data(), 1, used, file) == used;
+        used = 0;
+        return ok && std::fflush(file) == 0;
+    }
+    bool close() {
+        if (!file) return true;
+        bool ok = flush();
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+    long long written() const { return records; }
+
+private:
+    std::FILE* file;
+    std::vector<unsigned char> buffer;
+    int boardSize;
+    std::size_t used;
+    long long records;
+};
+
+// Streams games back out of a record file
+class GameRecordReader {
+public:
+    static constexpr std::size_t BUFFER_BYTES = 1 << 20;
+
+    GameRecordReader() : file(nullptr), variant(-1), boardSize(0), begin(0), end(0), corrupt(false) {}
+    ~GameRecordReader() { close(); }
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+
+    // Function to open a record file and check its header; returns false if it is not one
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        buffer.resize(BUFFER_BYTES);
+        unsigned char header[record_format::HEADER_BYTES];
+        if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+            std::memcmp(header, record_format::MAGIC, sizeof(record_format::MAGIC)) != 0 ||
+            header[4] != record_format::VERSION || header[5] >= VARIANT_COUNT) {
+            close();
+            return false;
+        }
+        variant = header[5];
+        boardSize = VARIANTS[variant].size;
+        begin = end = 0;
+        corrupt = false;
+        return true;
+    }
+    void close() {
+        if (file) std::fclose(file);
+        file = nullptr;
+    }
+
+    // Function to read the next game into record; returns false at the end of the file or on bad data
+    bool next(GameRecord& record) {
+        if (!file || corrupt) return false;
+        if (end - begin < record_format::MAX_RECORD_BYTES) refill();
+        if (begin == end) return false;
+        std::size_t n = record_format::decode(boardSize, buffer.data() + begin, buffer.data() + end, record);
+        if (n == 0) {
+            corrupt = true;
+            return false;
+        }
+        begin += n;
+        return true;
+    }
+
+    int variantIndex() const { return variant; }
+    // True if reading stopped on a malformed or truncated record rather than at the end
+    bool failed() const { return corrupt; }
+
+private:
+    // Function to move the unread bytes to the front of the buffer and fill the rest from the file
+    void refill() {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        end += std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+    }
+
+    std::FILE* file;
+    std::vector<unsigned char> buffer;
+    int variant;
+    int boardSize;
+    std::size_t begin;
+    std::size_t end;
+    bool corrupt;
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Input recordings: everything a session's simulation consumed, stamped with the simulation
+// step it was consumed at, so the session can be run again exactly.
+//
+// The simulation advances in fixed steps (see TicTacToeGame::run) and draws its random
+// numbers from generators seeded by the session seed, so given the seed, the input of each
+// step and the step each AI move landed on, every step computes the same thing again.
+//
+// A file is a 16-byte header ("TTTI", version, the session seed) followed by 16-byte records
+// in step order. Within a step the records are in the order they were consumed: events and
+// mouse state before the step runs, then an AI move applied during it. The last record is
+// INPUT_END with a checksum of the simulation state, which a replay compares against its own.
+
+enum InputRecordType : std::uint8_t {
+    INPUT_STATE = 1,   // mouse position and buttons changed: x, y, flags
+    INPUT_CLICK,       // a mouse button went down at x, y
+    INPUT_ESCAPE,      // the Escape key was pressed
+    INPUT_AI_MOVE,     // the pending AI move was applied during this step; x is the cell
+    INPUT_END          // the session ended before this step; x and y hold the checksum
+};
+
+// Bits of InputRecord::flags for INPUT_STATE
+enum InputStateFlags : std::uint8_t {
+    INPUT_MOUSE_DOWN = 1,
+    INPUT_ESCAPE_DOWN = 2
+};
+
+struct InputRecord {
+    std::uint32_t step;
+    std::uint8_t type;
+    std::uint8_t flags;
+    std::uint16_t reserved;
+    std::int32_t x;
+    std::int32_t y;
+};
+static_assert(sizeof(InputRecord) == 16, "input records are 16 bytes on disk");
+
+namespace input_format {
+
+constexpr char MAGIC[4] = {'T', 'T', 'T', 'I'};
+constexpr std::uint8_t VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 16;
+
+}  // namespace input_format
+
+// Writes a recording as the session runs
+class InputRecorder {
+public:
+    InputRecorder() : file(nullptr), records(0) {}
+    ~InputRecorder() { close(); }
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // Function to create (or truncate) a recording for a session seed; returns false on failure
+    bool open(const std::string& path, std::uint64_t seed) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        unsigned char header[input_format::HEADER_BYTES] = {};
+        std::memcpy(header, input_format::MAGIC, sizeof(input_format::MAGIC));
+        header[4] = input_format::VERSION;
+        std::memcpy(header + 8, &seed, sizeof(seed));
+        records = 0;
+        if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+    bool isOpen() const { return file != nullptr; }
+
+    // Function to append one record (stdio buffers the writes)
+    void add(std::uint32_t step, InputRecordType type, std::int32_t x = 0, std::int32_t y = 0, std::uint8_t flags = 0) {
+        if (!file) return;
+        InputRecord record = {step, type, flags, 0, x, y};
+        std::fwrite(&record, sizeof(record), 1, file);
+        records++;
+    }
+    // Function to end the recording with the checksum of the final simulation state and close it
+    bool finish(std::uint32_t step, std::uint64_t checksum) {
+        if (!file) return false;
+        add(step, INPUT_END, static_cast<std::int32_t>(checksum & 0xFFFFFFFFu), static_cast<std::int32_t>(checksum >> 32));
+        return close();
+    }
+    bool close() {
+        if (!file) return true;
+        bool ok = std::fclose(file) == 0;
+        file = nullptr;
+        return ok;
+    }
+    long long written() const { return records; }
+
+private:
+    std::FILE* file;
+    long long records;
+};
+
+// Reads a recording back one record at a time; recordings are small, so it is loaded whole
+class InputReplay {
+public:
+    InputReplay() : sessionSeed(0), cursor(0), loaded(false) {}
+
+    // Function to load a recording and check its header; returns false if it is not one
+    bool open(const std::string& path) {
+        loaded = false;
+        records.clear();
+        cursor = 0;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        unsigned char header[input_format::HEADER_BYTES];
+        bool ok = std::fread(header, 1, sizeof(header), file) == sizeof(header) &&
+                  std::memcmp(header, input_format::MAGIC, sizeof(input_format::MAGIC)) == 0 &&
+                  header[4] == input_format::VERSION;
+        if (ok) {
+            std::memcpy(&sessionSeed, header + 8, sizeof(sessionSeed));
+            InputRecord record;
+            while (std::fread(&record, sizeof(record), 1, file) == 1) records.push_back(record);
+            // A recording cut short (the game crashed, say) still replays up to where it stops
+        }
+        std::fclose(file);
+        loaded = ok;
+        return ok;
+    }
+    bool isOpen() const { return loaded; }
+    std::uint64_t seed() const { return sessionSeed; }
+
+    // The next unconsumed record if it belongs to a step or an earlier one (which a replay that
+    // has gone out of step failed to consume), else nullptr
+    const InputRecord* peek(std::uint32_t step) const {
+        return (cursor < records.size() && records[cursor].step <= step) ? &records[cursor] : nullptr;
+    }
+    void advance() { cursor++; }
+    // True once every record has been consumed
+    bool finished() const { return cursor >= records.size(); }
+    // Checksum stored in the INPUT_END record (0 when the recording has none)
+    std::uint64_t expectedChecksum() const {
+        if (records.empty() || records.back().type != INPUT_END) return 0;
+        return static_cast<std::uint32_t>(records.back().x) | static_cast<std::uint64_t>(static_cast<std::uint32_t>(records.back().y)) << 32;
+    }
+
+private:
+    std::vector<InputRecord> records;
+    std::uint64_t sessionSeed;
+    std::size_t cursor;
+    bool loaded;
+};
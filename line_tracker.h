@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "board.h"
+#include "zobrist.h"
+
+// Board plus, for every win line, how many pieces each player has on it.
+//
+// make() and unmake() only touch the lines through the cell played (at most 4K of them),
+// and keep two running summaries up to date as they go: how many complete lines each
+// player owns, and the set of "threat" lines where a player has K - 1 pieces and the
+// opponent none. Win detection and finding an immediate win or block are then O(1) plus
+// one mask lookup, instead of a scan of every line on the board. The Zobrist key of the
+// position is kept up to date the same way.
+template <int N, int K>
+class LineTracker {
+public:
+    using BoardType = BasicBoard<N, K>;
+    using Mask = typename BoardType::Mask;
+    static constexpr int LINE_COUNT = BoardType::LINE_COUNT;
+
+    LineTracker() { reset(); }
+    explicit LineTracker(const BoardType& position) { assign(position); }
+
+    // Function to go back to the empty board
+    void reset() {
+        board = BoardType();
+        hash = zobrist::Keys<N>::ROOT;
+        for (int p = 0; p < 2; p++) {
+            counts[p].fill(0);
+            threatTotal[p] = 0;
+            wonLines[p] = 0;
+        }
+    }
+    // Function to rebuild the counts for an arbitrary position
+    void assign(const BoardType& position) {
+        reset();
+        for (int cell = 0; cell < BoardType::CELLS; cell++) {
+            CellState state = position.at(cell);
+            if (state != EMPTY) make(cell, state);
+        }
+    }
+
+    // Function to place a piece on an empty cell; returns true when it completes a line
+    bool make(int cell, CellState player) {
+        board.place(cell, player);
+        hash ^= zobrist::Keys<N>::pieceKey(cell, player);
+        int p = player - 1;
+        int q = 1 - p;
+        bool completes = false;
+        const auto& lines = BoardType::CELL_LINES.lines[cell];
+        for (int i = 0; i < BoardType::CELL_LINES.count[cell]; i++) {
+            int line = lines[i];
+            int mine = ++counts[p][line];
+            int theirs = counts[q][line];
+            if (theirs == 0) {
+                if (mine == K - 1) {
+                    addThreat(p, line);
+                } else if (mine == K) {
+                    removeThreat(p, line);
+                    wonLines[p]++;
+                    completes = true;
+                }
+            } else if (mine == 1 && theirs == K - 1) {
+                // Our piece blocks the opponent's line
+                removeThreat(q, line);
+            }
+        }
+        return completes;
+    }
+    // Function to take back the piece on a cell
+    void unmake(int cell) {
+        CellState player = board.at(cell);
+        int p = player - 1;
+        int q = 1 - p;
+        hash ^= zobrist::Keys<N>::pieceKey(cell, player);
+        board.clear(cell);
+        const auto& lines = BoardType::CELL_LINES.lines[cell];
+        for (int i = 0; i < BoardType::CELL_LINES.count[cell]; i++) {
+            int line = lines[i];
+            int mine = counts[p][line]--;
+            int theirs = counts[q][line];
+            if (theirs == 0) {
+                if (mine == K) {
+                    wonLines[p]--;
+                    addThreat(p, line);
+                } else if (mine == K - 1) {
+                    removeThreat(p, line);
+                }
+            } else if (mine == 1 && theirs == K - 1) {
+                addThreat(q, line);
+            }
+        }
+    }
+
+    const BoardType& position() const { return board; }
+    std::uint64_t key() const { return hash; }
+    bool hasWin(CellState player) const { return wonLines[player - 1] > 0; }
+    bool checkWin() const { return wonLines[0] > 0 || wonLines[1] > 0; }
+
+    // Pieces the player has on each line
+    const std::array<std::uint8_t, LINE_COUNT>& lineCounts(CellState player) const { return counts[player - 1]; }
+    // Number of lines the player can complete with one more piece
+    int threatCount(CellState player) const { return threatTotal[player - 1]; }
+    // Function to find an empty cell completing one of the player's lines (-1 if none)
+    int completingCell(CellState player) const {
+        int p = player - 1;
+        if (threatTotal[p] == 0) return -1;
+        Mask gap = BoardType::WIN_MASKS[threatList[p][0]] & board.emptyMask();
+        return gap.lowest();
+    }
+
+private:
+    // Functions to add a line to or remove it from a player's threat set (swap-with-last removal)
+    void addThreat(int p, int line) {
+        threatSlot[p][line] = static_cast<std::int16_t>(threatTotal[p]);
+        threatList[p][threatTotal[p]++] = static_cast<std::int16_t>(line);
+    }
+    void removeThreat(int p, int line) {
+        std::int16_t slot = threatSlot[p][line];
+        std::int16_t last = threatList[p][--threatTotal[p]];
+        threatList[p][slot] = last;
+        threatSlot[p][last] = slot;
+    }
+
+    BoardType board;
+    std::uint64_t hash;
+    std::array<std::uint8_t, LINE_COUNT> counts[2];
+    std::array<std::int16_t, LINE_COUNT> threatList[2];
+    std::array<std::int16_t, LINE_COUNT> threatSlot[2];   // index in threatList of each threat line
+    int threatTotal[2];
+    int wonLines[2];
+};
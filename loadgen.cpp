@@ -0,0 +1,315 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "game_logic.h"
+#include "match_protocol.h"
+#include "variant.h"
+
+using namespace std;
+
+// Load generator for the match server. It opens a number of loopback connections and keeps
+// a number of matches going on each, playing random legal moves as X, and reports the AI
+// moves served per second and the latency from sending a move to receiving the AI's reply.
+//
+//   loadgen [--port N] [--connections N] [--matches N] [--seconds S] [--board 3x3|4x4|7x7|15x15]
+//           [--level LEVEL] [--seed S]
+//
+// --matches is per connection; LEVEL is easy, medium, hard, expert or 1-4.
+
+struct LoadOptions {
+    uint16_t port = protocol::DEFAULT_PORT;
+    int connections = 32;
+    int matchesPerConnection = 64;
+    double seconds = 10;
+    int variantIndex = 0;
+    int difficulty = 1;
+    uint64_t seed = 1;
+};
+
+// Client side of one match: which cells are taken and when the last move was sent
+struct ClientMatch {
+    bitset<15 * 15> taken;
+    int moves = 0;
+    chrono::steady_clock::time_point sentAt;
+};
+
+struct ClientConnection {
+    int fd = -1;
+    vector<unsigned char> in;
+    vector<unsigned char> out;
+    vector<ClientMatch> matches;
+};
+
+struct LoadTally {
+    long long aiMoves = 0;
+    long long games = 0;
+    long long xWins = 0;
+    long long oWins = 0;
+    long long draws = 0;
+    long long errors = 0;
+    // Move-to-AI-move latencies in microseconds
+    vector<uint32_t> latencies;
+};
+
+class LoadGenerator {
+public:
+    explicit LoadGenerator(const LoadOptions& loadOptions)
+        : options(loadOptions), cells(VARIANTS[loadOptions.variantIndex].size * VARIANTS[loadOptions.variantIndex].size),
+          random(loadOptions.seed), epollFd(-1) {}
+
+    ~LoadGenerator() {
+        for (ClientConnection& connection : connections) {
+            if (connection.fd >= 0) ::close(connection.fd);
+        }
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    // Function to open the connections and start every match; returns false if the server is unreachable
+    bool connectAll() {
+        epollFd = epoll_create1(0);
+        if (epollFd < 0) return false;
+        connections.resize(options.connections);
+        for (int i = 0; i < options.connections; i++) {
+            ClientConnection& connection = connections[i];
+            connection.fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(options.port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connection.fd < 0 || connect(connection.fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                return false;
+            }
+            int yes = 1;
+            setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+            connection.matches.resize(options.matchesPerConnection);
+            for (int m = 0; m < options.matchesPerConnection; m++) {
+                queue(connection, protocol::NEW_MATCH, static_cast<uint8_t>(options.variantIndex),
+                      static_cast<uint16_t>(options.difficulty), static_cast<uint32_t>(m));
+            }
+            if (!flush(connection)) return false;
+        }
+        return true;
+    }
+
+    // Function to keep every match busy until the time is up
+    LoadTally run() {
+        LoadTally tally;
+        vector<epoll_event> events(256);
+        auto start = chrono::steady_clock::now();
+        auto stopAt = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(options.seconds));
+        while (chrono::steady_clock::now() < stopAt) {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 100);
+            if (ready < 0 && errno != EINTR) break;
+            for (int i = 0; i < ready; i++) {
+                ClientConnection& connection = connections[events[i].data.u32];
+                if (!receive(connection, tally)) {
+                    cerr << "Server closed a connection" << endl;
+                    return tally;
+                }
+                flush(connection);
+            }
+        }
+        return tally;
+    }
+
+private:
+    void queue(ClientConnection& connection, uint8_t type, uint8_t arg, uint16_t cell, uint32_t matchId) {
+        protocol::Message message;
+        message.type = type;
+        message.arg = arg;
+        message.cell = cell;
+        message.matchId = matchId;
+        size_t at = connection.out.size();
+        connection.out.resize(at + protocol::MESSAGE_BYTES);
+        protocol::encode(message, connection.out.data() + at);
+    }
+
+    // Function to send everything queued; the socket is blocking, so this returns when it is all written
+    bool flush(ClientConnection& connection) {
+        size_t sent = 0;
+        while (sent < connection.out.size()) {
+            ssize_t n = ::send(connection.fd, connection.out.data() + sent, connection.out.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        connection.out.clear();
+        return true;
+    }
+
+    // Function to play a random empty cell in a match
+    void playMove(ClientConnection& connection, uint32_t matchId) {
+        ClientMatch& match = connection.matches[matchId];
+        random = random * 6364136223846793005ull + 1442695040888963407ull;
+        int free = cells - static_cast<int>(match.taken.count());
+        int pick = static_cast<int>((random >> 33) % free);
+        int cell = 0;
+        for (; cell < cells; cell++) {
+            if (!match.taken[cell] && pick-- == 0) break;
+        }
+        match.taken.set(cell);
+        match.moves++;
+        match.sentAt = chrono::steady_clock::now();
+        queue(connection, protocol::MOVE, 0, static_cast<uint16_t>(cell), matchId);
+    }
+
+    void finishGame(ClientConnection& connection, uint32_t matchId, uint8_t status, LoadTally& tally) {
+        tally.games++;
+        if (status == protocol::X_WON) tally.xWins++;
+        else if (status == protocol::O_WON) tally.oWins++;
+        else tally.draws++;
+        queue(connection, protocol::NEW_MATCH, static_cast<uint8_t>(options.variantIndex),
+              static_cast<uint16_t>(options.difficulty), matchId);
+    }
+
+    bool receive(ClientConnection& connection, LoadTally& tally) {
+        unsigned char buffer[64 * 1024];
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) return false;
+        connection.in.insert(connection.in.end(), buffer, buffer + received);
+        size_t offset = 0;
+        auto now = chrono::steady_clock::now();
+        while (connection.in.size() - offset >= protocol::MESSAGE_BYTES) {
+            protocol::Message message = protocol::decode(connection.in.data() + offset);
+            offset += protocol::MESSAGE_BYTES;
+            if (message.matchId >= connection.matches.size()) {
+                tally.errors++;
+                continue;
+            }
+            ClientMatch& match = connection.matches[message.matchId];
+            if (message.type == protocol::STARTED) {
+                match.taken.reset();
+                match.moves = 0;
+                playMove(connection, message.matchId);
+                continue;
+            }
+            if (message.type == protocol::FAILED) {
+                tally.errors++;
+                // The match may still be going on the server, so it is ended before the slot
+                // starts again; errors that a new match would only repeat retire the slot
+                if (message.arg != protocol::BAD_MESSAGE && message.arg != protocol::TOO_MANY_MATCHES) {
+                    queue(connection, protocol::END_MATCH, 0, 0, message.matchId);
+                }
+                continue;
+            }
+            if (message.type == protocol::ENDED) {
+                queue(connection, protocol::NEW_MATCH, static_cast<uint8_t>(options.variantIndex),
+                      static_cast<uint16_t>(options.difficulty), message.matchId);
+                continue;
+            }
+            // MOVED answers a game-ending client move with no search behind it, so only AI moves are timed
+            if (message.type == protocol::AI_MOVED) {
+                tally.aiMoves++;
+                tally.latencies.push_back(static_cast<uint32_t>(chrono::duration_cast<chrono::microseconds>(now - match.sentAt).count()));
+                if (message.cell < cells) match.taken.set(message.cell);
+            }
+            if (message.arg != protocol::ONGOING) {
+                finishGame(connection, message.matchId, message.arg, tally);
+            } else {
+                playMove(connection, message.matchId);
+            }
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+        return true;
+    }
+
+    LoadOptions options;
+    int cells;
+    uint64_t random;
+    int epollFd;
+    vector<ClientConnection> connections;
+};
+
+// Function to parse a difficulty name or number (0 when invalid)
+int parseDifficulty(const string& text) {
+    for (int level = 1; level <= DIFFICULTY_COUNT; level++) {
+        string name = difficultyName(level);
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (text == name || text == to_string(level)) return level;
+    }
+    return 0;
+}
+
+// Function to parse the board name (-1 when invalid)
+int parseVariant(const string& text) {
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        if (text == VARIANTS[i].name) return i;
+    }
+    return -1;
+}
+
+void printUsage() {
+    cerr << "usage: loadgen [--port N] [--connections N] [--matches N] [--seconds S]\n"
+            "               [--board 3x3|4x4|7x7|15x15] [--level LEVEL] [--seed S]\n";
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--port") options.port = static_cast<uint16_t>(atoi(value.c_str()));
+        else if (arg == "--connections") options.connections = atoi(value.c_str());
+        else if (arg == "--matches") options.matchesPerConnection = atoi(value.c_str());
+        else if (arg == "--seconds") options.seconds = atof(value.c_str());
+        else if (arg == "--board") options.variantIndex = parseVariant(value);
+        else if (arg == "--level") options.difficulty = parseDifficulty(value);
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), nullptr, 10);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.connections < 1 || options.matchesPerConnection < 1 || options.seconds <= 0 ||
+        options.variantIndex < 0 || options.difficulty < 1) {
+        printUsage();
+        return 1;
+    }
+
+    LoadGenerator generator(options);
+    if (!generator.connectAll()) {
+        cerr << "Could not connect to 127.0.0.1:" << options.port << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    cout << "Load: " << options.connections << " connections x " << options.matchesPerConnection << " matches on "
+         << VARIANTS[options.variantIndex].name << " against " << difficultyName(options.difficulty)
+         << " for " << options.seconds << " s" << endl;
+    LoadTally tally = generator.run();
+
+    vector<uint32_t>& latencies = tally.latencies;
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) {
+        if (latencies.empty()) return 0.0;
+        return latencies[min(latencies.size() - 1, static_cast<size_t>(q * latencies.size()))] / 1000.0;
+    };
+    cout.setf(ios::fixed);
+    cout.precision(2);
+    cout << "Moves:   " << tally.aiMoves << " AI moves (" << tally.aiMoves / options.seconds << " AI moves/s)\n"
+         << "Games:   " << tally.games << " (X " << tally.xWins << ", O " << tally.oWins << ", draws " << tally.draws
+         << "), errors " << tally.errors << "\n"
+         << "Latency: p50 " << percentile(0.50) << " ms | p99 " << percentile(0.99) << " ms | p99.9 "
+         << percentile(0.999) << " ms | max " << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << " ms" << endl;
+    return 0;
+}
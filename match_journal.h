@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "game_logic.h"
+#include "variant.h"
+
+// Append-only binary history of finished games, written through a memory map (POSIX).
+//
+// The file starts with a fixed-size header that holds the record count and running totals
+// per mode/difficulty and per opening move, followed by 32-byte records. Opening the
+// journal reads only the header, so startup time does not depend on how many games are
+// stored, and the common queries are answered from the totals in constant time. Anything
+// else can scan the records, which sit contiguously in memory.
+//
+// Appending writes the record, then the record count, then the totals, then the count of
+// records the totals cover. Writes to a shared mapping survive a crash of the process; the
+// pages are flushed to disk every FLUSH_INTERVAL games and on close, which bounds what a
+// power loss can take. If the totals do not cover every record on open (the game stopped
+// between those writes), they are rebuilt from the records.
+
+// Outcome counts for one group of games
+struct ResultCounts {
+    std::uint64_t xWins = 0;
+    std::uint64_t oWins = 0;
+    std::uint64_t draws = 0;
+
+    std::uint64_t total() const { return xWins + oWins + draws; }
+};
+
+// One finished game. Moves are cell indices in play order; only the first MAX_MOVES are
+// kept, which covers whole games on 3x3 and 4x4 and the opening on the larger boards.
+struct MatchRecord {
+    static constexpr int MAX_MOVES = 18;
+
+    std::int64_t timestamp;     // seconds since the epoch
+    std::uint8_t variant;       // index into VARIANTS
+    std::uint8_t mode;          // GameMode
+    std::uint8_t difficulty;    // 1-4 against the AI, 0 for two players
+    std::uint8_t winner;        // 1 X, 2 O, 0 draw
+    std::uint16_t moveCount;    // moves in the whole game
+    std::uint8_t moves[MAX_MOVES];
+};
+static_assert(sizeof(MatchRecord) == 32, "journal records are 32 bytes on disk");
+
+class MatchJournal {
+public:
+    // Games between flushes of the mapped pages to disk
+    static constexpr int FLUSH_INTERVAL = 16;
+    // Cells of every board, for the per-opening totals
+    static constexpr int OPENING_CELLS = 9 + 16 + 49 + 225;
+    static constexpr int MAX_DIFFICULTY = 4;
+
+    MatchJournal() : fd(-1), map(nullptr), mappedBytes(0), unflushed(0) {}
+    ~MatchJournal() { close(); }
+    MatchJournal(const MatchJournal&) = delete;
+    MatchJournal& operator=(const MatchJournal&) = delete;
+
+    // Function to open or create the journal at path; returns false if it cannot be used
+    bool open(const std::string& path) {
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close();
+            return false;
+        }
+        bool created = info.st_size == 0;
+        if (!created && static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+            close();
+            return false;
+        }
+        if (!mapFile(created ? bytesFor(GROWTH_RECORDS) : static_cast<std::size_t>(info.st_size))) {
+            close();
+            return false;
+        }
+        if (created) {
+            std::memcpy(header()->magic, MAGIC, sizeof(header()->magic));
+            header()->version = VERSION;
+            header()->recordSize = sizeof(MatchRecord);
+            flush();
+        } else if (std::memcmp(header()->magic, MAGIC, sizeof(header()->magic)) != 0 ||
+                   header()->version != VERSION || header()->recordSize != sizeof(MatchRecord) ||
+                   bytesFor(header()->recordCount) > mappedBytes) {
+            close();
+            return false;
+        }
+        if (header()->summarizedCount != header()->recordCount) rebuildTotals();
+        return true;
+    }
+    bool isOpen() const { return map != nullptr; }
+
+    // Function to flush and unmap the journal
+    void close() {
+        if (map) {
+            msync(map, mappedBytes, MS_SYNC);
+            munmap(map, mappedBytes);
+        }
+        if (fd >= 0) ::close(fd);
+        map = nullptr;
+        fd = -1;
+        mappedBytes = 0;
+        unflushed = 0;
+    }
+
+    // Function to append a finished game; returns false if the file could not grow
+    bool append(GameMode mode, int difficulty, int variantIndex, int winner, const std::vector<int>& moves,
+                std::int64_t timestamp = static_cast<std::int64_t>(std::time(nullptr))) {
+        if (!map) return false;
+        std::uint64_t index = header()->recordCount;
+        if (bytesFor(index + 1) > mappedBytes && !mapFile(bytesFor(index + GROWTH_RECORDS))) return false;
+
+        MatchRecord& record = records()[index];
+        std::memset(&record, 0, sizeof(record));
+        record.timestamp = timestamp;
+        record.variant = static_cast<std::uint8_t>(variantIndex);
+        record.mode = static_cast<std::uint8_t>(mode);
+        record.difficulty = static_cast<std::uint8_t>(mode == PLAYER_VS_AI ? difficulty : 0);
+        record.winner = static_cast<std::uint8_t>(winner);
+        record.moveCount = static_cast<std::uint16_t>(moves.size());
+        for (std::size_t i = 0; i < moves.size() && i < MatchRecord::MAX_MOVES; i++) {
+            record.moves[i] = static_cast<std::uint8_t>(moves[i]);
+        }
+        header()->recordCount = index + 1;
+        addToTotals(record);
+        header()->summarizedCount = index + 1;
+
+        if (++unflushed >= FLUSH_INTERVAL) flush();
+        return true;
+    }
+
+    // Function to schedule the mapped pages for writing to disk
+    void flush() {
+        if (!map) return;
+        msync(map, mappedBytes, MS_ASYNC);
+        unflushed = 0;
+    }
+
+    // Function to carry over the totals of the old text statistics file; only done for an empty journal
+    bool importLegacy(const GameStats& legacy) {
+        if (!map || header()->recordCount != 0 || header()->legacyGames != 0) return false;
+        header()->legacyPlayerWins = legacy.playerWins;
+        header()->legacyAIWins = legacy.aiWins;
+        header()->legacyDraws = legacy.draws;
+        header()->legacyGames = legacy.totalGames;
+        flush();
+        return true;
+    }
+
+    std::uint64_t size() const { return map ? header()->recordCount : 0; }
+    const MatchRecord& operator[](std::size_t index) const { return records()[index]; }
+    const MatchRecord* begin() const { return map ? records() : nullptr; }
+    const MatchRecord* end() const { return map ? records() + header()->recordCount : nullptr; }
+
+    // Results of every game in a mode at one difficulty (0 for two-player games)
+    ResultCounts results(GameMode mode, int difficulty) const {
+        if (!map || difficulty < 0 || difficulty > MAX_DIFFICULTY) return ResultCounts();
+        return toCounts(header()->byLevel[mode][difficulty]);
+    }
+    // Results of every game on a board that opened on the given cell
+    ResultCounts openingResults(int variantIndex, int firstCell) const {
+        int slot = openingSlot(variantIndex, firstCell);
+        if (!map || slot < 0) return ResultCounts();
+        return toCounts(header()->byOpening[slot]);
+    }
+    // The menu statistics: every recorded game plus the imported legacy totals
+    GameStats stats() const {
+        GameStats stats;
+        if (!map) return stats;
+        const Header* h = header();
+        for (int mode = 0; mode < 2; mode++) {
+            for (int level = 0; level <= MAX_DIFFICULTY; level++) {
+                const std::uint64_t* counts = h->byLevel[mode][level];
+                stats.draws += static_cast<int>(counts[DRAW]);
+                if (mode == PLAYER_VS_AI) {
+                    stats.playerWins += static_cast<int>(counts[X_WIN]);
+                    stats.aiWins += static_cast<int>(counts[O_WIN]);
+                } else {
+                    stats.playerWins += static_cast<int>(counts[X_WIN] + counts[O_WIN]);
+                }
+            }
+        }
+        stats.playerWins += static_cast<int>(h->legacyPlayerWins);
+        stats.aiWins += static_cast<int>(h->legacyAIWins);
+        stats.draws += static_cast<int>(h->legacyDraws);
+        stats.totalGames = stats.playerWins + stats.aiWins + stats.draws;
+        return stats;
+    }
+
+private:
+    enum { X_WIN, O_WIN, DRAW };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::uint64_t recordCount;
+        std::uint64_t summarizedCount;
+        std::uint64_t legacyPlayerWins;
+        std::uint64_t legacyAIWins;
+        std::uint64_t legacyDraws;
+        std::uint64_t legacyGames;
+        std::uint64_t byLevel[2][MAX_DIFFICULTY + 1][3];
+        std::uint64_t byOpening[OPENING_CELLS][3];
+    };
+    // Records start on a page boundary after the header
+    static constexpr std::size_t HEADER_BYTES = (sizeof(Header) + 4095) / 4096 * 4096;
+    // Records added each time the file grows
+    static constexpr std::uint64_t GROWTH_RECORDS = 1 << 15;
+    static constexpr char MAGIC[8] = {'T', 'T', 'T', 'J', 'R', 'N', 'L', '1'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    Header* header() const { return reinterpret_cast<Header*>(map); }
+    MatchRecord* records() const { return reinterpret_cast<MatchRecord*>(static_cast<char*>(map) + HEADER_BYTES); }
+    static std::size_t bytesFor(std::uint64_t records) { return HEADER_BYTES + records * sizeof(MatchRecord); }
+
+    // Function to size the file to at least bytes and map all of it
+    bool mapFile(std::size_t bytes) {
+        if (map) {
+            msync(map, mappedBytes, MS_SYNC);
+            munmap(map, mappedBytes);
+            map = nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) return false;
+        if (static_cast<std::size_t>(info.st_size) < bytes && ftruncate(fd, static_cast<off_t>(bytes)) != 0) return false;
+        bytes = std::max(bytes, static_cast<std::size_t>(info.st_size));
+        void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) return false;
+        map = address;
+        mappedBytes = bytes;
+        return true;
+    }
+
+    static int openingSlot(int variantIndex, int cell) {
+        if (variantIndex < 0 || variantIndex >= VARIANT_COUNT) return -1;
+        int offset = 0;
+        for (int i = 0; i < variantIndex; i++) offset += VARIANTS[i].size * VARIANTS[i].size;
+        int cells = VARIANTS[variantIndex].size * VARIANTS[variantIndex].size;
+        if (cell < 0 || cell >= cells || offset + cells > OPENING_CELLS) return -1;
+        return offset + cell;
+    }
+
+    static ResultCounts toCounts(const std::uint64_t* counts) {
+        ResultCounts result;
+        result.xWins = counts[X_WIN];
+        result.oWins = counts[O_WIN];
+        result.draws = counts[DRAW];
+        return result;
+    }
+
+    void addToTotals(const MatchRecord& record) {
+        int outcome = record.winner == 1 ? X_WIN : (record.winner == 2 ? O_WIN : DRAW);
+        int mode = record.mode == PLAYER_VS_AI ? PLAYER_VS_AI : PLAYER_VS_PLAYER;
+        int level = std::min<int>(record.difficulty, MAX_DIFFICULTY);
+        header()->byLevel[mode][level][outcome]++;
+        int slot = record.moveCount > 0 ? openingSlot(record.variant, record.moves[0]) : -1;
+        if (slot >= 0) header()->byOpening[slot][outcome]++;
+    }
+
+    // Function to recompute the totals from the records after an interrupted append
+    void rebuildTotals() {
+        Header* h = header();
+        std::memset(h->byLevel, 0, sizeof(h->byLevel));
+        std::memset(h->byOpening, 0, sizeof(h->byOpening));
+        for (std::uint64_t i = 0; i < h->recordCount; i++) addToTotals(records()[i]);
+        h->summarizedCount = h->recordCount;
+        flush();
+    }
+
+    int fd;
+    void* map;
+    std::size_t mappedBytes;
+    int unflushed;
+};
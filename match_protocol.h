@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Wire protocol between the match server and its clients: fixed 8-byte little-endian
+// messages over a stream socket, so a reader never has to search for message boundaries.
+//
+//   byte 0     message type
+//   byte 1     argument: the board for NEW_MATCH, the game status in replies, the error code
+//   bytes 2-3  cell (the difficulty for NEW_MATCH)
+//   bytes 4-7  match id, chosen by the client and unique within its connection
+//
+// The client plays X and moves first; the server answers every MOVE with either MOVED
+// (the client's move ended the game) or AI_MOVED (the server's reply and the new status).
+namespace protocol {
+
+constexpr std::size_t MESSAGE_BYTES = 8;
+constexpr std::uint16_t DEFAULT_PORT = 7777;
+
+enum MessageType : std::uint8_t {
+    // Client to server
+    NEW_MATCH = 1,
+    MOVE = 2,
+    END_MATCH = 3,
+    // Server to client
+    STARTED = 16,
+    MOVED = 17,
+    AI_MOVED = 18,
+    ENDED = 19,
+    FAILED = 20
+};
+
+enum GameStatus : std::uint8_t {
+    ONGOING = 0,
+    X_WON = 1,
+    O_WON = 2,
+    DRAWN = 3
+};
+
+enum ErrorCode : std::uint8_t {
+    BAD_MESSAGE = 1,
+    UNKNOWN_MATCH = 2,
+    ILLEGAL_MOVE = 3,
+    NOT_YOUR_TURN = 4,
+    MATCH_EXISTS = 5,
+    TOO_MANY_MATCHES = 6
+};
+
+struct Message {
+    std::uint8_t type = 0;
+    std::uint8_t arg = 0;
+    std::uint16_t cell = 0;
+    std::uint32_t matchId = 0;
+};
+
+inline void encode(const Message& message, unsigned char* out) {
+    out[0] = message.type;
+    out[1] = message.arg;
+    out[2] = static_cast<unsigned char>(message.cell);
+    out[3] = static_cast<unsigned char>(message.cell >> 8);
+    for (int i = 0; i < 4; i++) out[4 + i] = static_cast<unsigned char>(message.matchId >> (8 * i));
+}
+
+inline Message decode(const unsigned char* in) {
+    Message message;
+    message.type = in[0];
+    message.arg = in[1];
+    message.cell = static_cast<std::uint16_t>(in[2] | (in[3] << 8));
+    message.matchId = static_cast<std::uint32_t>(in[4]) | (static_cast<std::uint32_t>(in[5]) << 8) |
+                      (static_cast<std::uint32_t>(in[6]) << 16) | (static_cast<std::uint32_t>(in[7]) << 24);
+    return message;
+}
+
+}  // namespace protocol
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include "board.h"
+#include "search.h"
+#include "thread_pool.h"
+
+// Budget for one MCTS move; zero means unlimited (at least one limit should be set)
+struct MCTSLimits {
+    long long maxPlayouts = 0;
+    std::chrono::milliseconds timeBudget{0};
+    std::uint64_t seed = 1;
+    const std::atomic<bool>* abortFlag = nullptr;
+};
+
+// Chosen move and throughput of an MCTS run
+struct MCTSResult {
+    int bestCell = -1;
+    long long playouts = 0;
+    double elapsedMs = 0;
+    double playoutsPerSecond = 0;
+    double winRate = 0;        // expected score of the chosen move, 0..1 (draw = 0.5)
+    int threads = 1;
+    bool arenaFull = false;    // the node pool ran out and the tree stopped growing
+};
+
+// Monte Carlo Tree Search (UCT) with tree parallelism. All threads grow one shared
+// tree whose nodes live in a preallocated arena; statistics are atomics, and a
+// virtual loss on every node a thread descends through steers the other threads
+// into different branches until the playout is backed up.
+template <class BoardT>
+class MCTSSearch {
+public:
+    using Mask = typename BoardT::Mask;
+    static constexpr int CELLS = BoardT::CELLS;
+    static constexpr double EXPLORATION = 1.4;
+
+    explicit MCTSSearch(ThreadPool* p = nullptr, std::uint32_t nodeCapacity = 1u << 20)
+        : pool(p), capacity(nodeCapacity), used(0) {}
+
+    void setThreadPool(ThreadPool* p) { pool = p; }
+    int threadCount() const { return pool ? pool->size() + 1 : 1; }
+
+    // Function to run playouts from the position until the budget is spent
+    MCTSResult search(const BoardT& root, const MCTSLimits& limits) {
+        auto start = std::chrono::steady_clock::now();
+        MCTSResult result;
+        result.threads = threadCount();
+        if (root.isTerminal()) return result;
+
+        // The arena is allocated on first use and recycled by resetting the bump pointer
+        if (!arena) arena = std::make_unique<Node[]>(capacity);
+        used = 0;
+        arenaFull = false;
+        playouts = 0;
+        stopped = false;
+        rootPosition = root;
+        rootToMove = root.sideToMove();
+        budget = limits;
+        deadline = start + limits.timeBudget;
+        allocate(1, -1);
+
+        if (pool && pool->size() > 0) {
+            TaskGroup group(*pool);
+            for (int t = 1; t < result.threads; t++) {
+                group.run([this, t]() { runPlayouts(t); });
+            }
+            runPlayouts(0);
+            group.wait();
+        } else {
+            runPlayouts(0);
+        }
+
+        // Most visited child is the most robust choice
+        const Node& rootNode = arena[0];
+        int bestVisits = -1;
+        for (std::uint32_t i = 0; i < rootNode.childCount.load(); i++) {
+            const Node& child = arena[rootNode.firstChild.load() + i];
+            int visits = child.visits.load();
+            if (visits > bestVisits) {
+                bestVisits = visits;
+                result.bestCell = child.move;
+                result.winRate = visits > 0 ? child.reward.load() * 0.5 / visits : 0;
+            }
+        }
+        if (result.bestCell == -1) result.bestCell = candidateMoves(root).lowest();
+
+        result.playouts = playouts;
+        result.arenaFull = arenaFull;
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        result.playoutsPerSecond = result.elapsedMs > 0 ? playouts * 1000.0 / result.elapsedMs : 0;
+        return result;
+    }
+
+private:
+    enum ExpandState : std::uint8_t { UNEXPANDED, EXPANDING, EXPANDED };
+
+    struct Node {
+        std::atomic<int> visits;
+        std::atomic<int> reward;       // twice the score of the player who moved into this node
+        std::atomic<int> virtualLoss;
+        std::atomic<std::uint32_t> firstChild;
+        std::atomic<std::uint32_t> childCount;
+        std::atomic<std::uint8_t> state;
+        std::int16_t move;
+    };
+
+    // Small per-thread xorshift generator for rollouts
+    struct Rng {
+        std::uint64_t state;
+        std::uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+        int below(int n) { return static_cast<int>(next() % static_cast<std::uint64_t>(n)); }
+    };
+
+    // Function to take count consecutive nodes from the arena (returns capacity when full)
+    std::uint32_t allocate(std::uint32_t count, int firstMove) {
+        std::uint32_t index = used.fetch_add(count);
+        if (index + count > capacity) {
+            arenaFull = true;
+            return capacity;
+        }
+        for (std::uint32_t i = 0; i < count; i++) {
+            Node& node = arena[index + i];
+            node.visits.store(0, std::memory_order_relaxed);
+            node.reward.store(0, std::memory_order_relaxed);
+            node.virtualLoss.store(0, std::memory_order_relaxed);
+            node.firstChild.store(0, std::memory_order_relaxed);
+            node.childCount.store(0, std::memory_order_relaxed);
+            node.state.store(UNEXPANDED, std::memory_order_relaxed);
+            node.move = static_cast<std::int16_t>(firstMove);
+        }
+        return index;
+    }
+
+    bool budgetSpent(long long done) const {
+        if (stopped.load(std::memory_order_relaxed)) return true;
+        if (budget.abortFlag && budget.abortFlag->load(std::memory_order_relaxed)) return true;
+        if (budget.maxPlayouts > 0 && done >= budget.maxPlayouts) return true;
+        if (budget.timeBudget.count() > 0 && (done & 63) == 0 && std::chrono::steady_clock::now() >= deadline) return true;
+        return false;
+    }
+
+    void runPlayouts(int threadIndex) {
+        Rng rng = {budget.seed * 0x9E3779B97F4A7C15ull + static_cast<std::uint64_t>(threadIndex) * 0xBF58476D1CE4E5B9ull + 1};
+        while (!budgetSpent(playouts.load(std::memory_order_relaxed))) {
+            playout(rng);
+            if (budgetSpent(playouts.fetch_add(1, std::memory_order_relaxed) + 1)) stopped = true;
+        }
+    }
+
+    // Function to pick the child with the best UCT score, counting virtual losses as lost visits
+    std::uint32_t selectChild(const Node& parent) const {
+        std::uint32_t first = parent.firstChild.load(std::memory_order_acquire);
+        std::uint32_t count = parent.childCount.load(std::memory_order_acquire);
+        double logParent = std::log(static_cast<double>(parent.visits.load(std::memory_order_relaxed) + 1));
+        std::uint32_t best = first;
+        double bestValue = -1;
+        for (std::uint32_t i = 0; i < count; i++) {
+            const Node& child = arena[first + i];
+            int n = child.visits.load(std::memory_order_relaxed) + child.virtualLoss.load(std::memory_order_relaxed);
+            if (n == 0) return first + i;
+            double value = child.reward.load(std::memory_order_relaxed) * 0.5 / n + EXPLORATION * std::sqrt(logParent / n);
+            if (value > bestValue) {
+                bestValue = value;
+                best = first + i;
+            }
+        }
+        return best;
+    }
+
+    // Function to create the children of a node; only the thread that wins the state change does it
+    void expand(Node& node, const BoardT& position) {
+        if (arenaFull.load(std::memory_order_relaxed)) return;
+        std::uint8_t expected = UNEXPANDED;
+        if (!node.state.compare_exchange_strong(expected, EXPANDING)) return;
+        Mask moves = candidateMoves(position);
+        std::uint32_t count = static_cast<std::uint32_t>(moves.count());
+        std::uint32_t first = allocate(count, -1);
+        if (first == capacity) {
+            node.state.store(UNEXPANDED);
+            return;
+        }
+        for (std::uint32_t i = 0; i < count; i++) arena[first + i].move = static_cast<std::int16_t>(moves.popLowest());
+        node.firstChild.store(first, std::memory_order_relaxed);
+        node.childCount.store(count, std::memory_order_relaxed);
+        node.state.store(EXPANDED, std::memory_order_release);
+    }
+
+    // Function to finish the game with uniformly random moves; returns the winner or EMPTY for a draw
+    CellState rollout(BoardT& position, CellState toMove, Rng& rng) const {
+        int empty[CELLS];
+        int count = 0;
+        Mask moves = position.emptyMask();
+        while (moves.any()) empty[count++] = moves.popLowest();
+        while (count > 0) {
+            int pick = rng.below(count);
+            int cell = empty[pick];
+            empty[pick] = empty[--count];
+            position.place(cell, toMove);
+            if (position.completesLine(cell, toMove)) return toMove;
+            toMove = opponentOf(toMove);
+        }
+        return EMPTY;
+    }
+
+    void playout(Rng& rng) {
+        std::uint32_t path[CELLS + 1];
+        int depth = 0;
+        BoardT position = rootPosition;
+        CellState toMove = rootToMove;
+        CellState winner = EMPTY;
+        bool finished = false;
+
+        // Selection: descend through expanded nodes, leaving a virtual loss behind
+        std::uint32_t current = 0;
+        path[depth++] = current;
+        while (arena[current].state.load(std::memory_order_acquire) == EXPANDED && arena[current].childCount.load() > 0) {
+            current = selectChild(arena[current]);
+            arena[current].virtualLoss.fetch_add(1, std::memory_order_relaxed);
+            path[depth++] = current;
+            int cell = arena[current].move;
+            position.place(cell, toMove);
+            if (position.completesLine(cell, toMove)) {
+                winner = toMove;
+                finished = true;
+                break;
+            }
+            if (position.isFull()) {
+                finished = true;
+                break;
+            }
+            toMove = opponentOf(toMove);
+        }
+
+        // Expansion of a leaf that has been visited before, then simulation
+        if (!finished) {
+            Node& leaf = arena[current];
+            if (leaf.visits.load(std::memory_order_relaxed) > 0 || depth == 1) expand(leaf, position);
+            winner = rollout(position, toMove, rng);
+        }
+
+        // Backpropagation: the node at depth d was entered by the root player's opponent when d is even
+        for (int d = depth - 1; d >= 0; d--) {
+            Node& node = arena[path[d]];
+            CellState mover = (d % 2 == 1) ? rootToMove : opponentOf(rootToMove);
+            int reward = (winner == EMPTY) ? 1 : (winner == mover) ? 2 : 0;
+            node.reward.fetch_add(reward, std::memory_order_relaxed);
+            node.visits.fetch_add(1, std::memory_order_relaxed);
+            if (d > 0) node.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    ThreadPool* pool;
+    std::unique_ptr<Node[]> arena;
+    std::uint32_t capacity;
+    std::atomic<std::uint32_t> used;
+    std::atomic<bool> arenaFull{false};
+    std::atomic<long long> playouts{0};
+    std::atomic<bool> stopped{false};
+    BoardT rootPosition;
+    CellState rootToMove = X_PLAYER;
+    MCTSLimits budget;
+    std::chrono::steady_clock::time_point deadline;
+};
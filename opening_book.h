@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "variant.h"
+#include "zobrist.h"
+
+// Opening book: for positions reached early in self-play, how each move scored.
+//
+// The file is a 32-byte header followed by 24-byte entries sorted by (position key, move),
+// one entry per move tried in a position. It is mapped read-only (POSIX mmap), so opening
+// a book costs the same whatever its size and a probe only touches the pages its binary
+// search lands on. Position keys are the Zobrist keys of zobrist.h, which the variants
+// keep up to date move by move, so a probe does not rehash the board.
+
+// Statistics of one move in one position, from the point of view of the side that played it
+struct BookEntry {
+    std::uint64_t key;
+    std::uint16_t cell;
+    std::uint16_t reserved;
+    std::uint32_t games;
+    std::uint32_t wins;
+    std::uint32_t draws;
+};
+static_assert(sizeof(BookEntry) == 24, "book entries are 24 bytes on disk");
+
+// Move suggested by the book
+struct BookMove {
+    int cell = -1;
+    std::uint32_t games = 0;
+    double score = 0;   // (wins + draws / 2) / games for the side to move
+};
+
+class OpeningBook {
+public:
+    // Moves seen in fewer games than this are not trusted
+    static constexpr std::uint32_t MIN_GAMES = 8;
+    // Standard errors a move's score must clear the position's average by
+    static constexpr double CONFIDENCE = 2.0;
+
+    OpeningBook() : map(nullptr), mappedBytes(0), entries(nullptr), count(0) {}
+    ~OpeningBook() { close(); }
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Function to map a book file; returns false if it is missing or not a book
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(Header);
+        if (ok) {
+            void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (address != MAP_FAILED) {
+                map = address;
+                mappedBytes = info.st_size;
+            }
+        }
+        ::close(fd);
+        if (!map) return false;
+        const Header* header = static_cast<const Header*>(map);
+        if (std::memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0 || header->version != VERSION ||
+            header->entrySize != sizeof(BookEntry) ||
+            sizeof(Header) + header->entryCount * sizeof(BookEntry) > mappedBytes) {
+            close();
+            return false;
+        }
+        entries = reinterpret_cast<const BookEntry*>(static_cast<const char*>(map) + sizeof(Header));
+        count = header->entryCount;
+        return true;
+    }
+    void close() {
+        if (map) munmap(map, mappedBytes);
+        map = nullptr;
+        mappedBytes = 0;
+        entries = nullptr;
+        count = 0;
+    }
+    bool isOpen() const { return map != nullptr; }
+    std::size_t size() const { return count; }
+
+    // Function to find the best legal move of the position that the statistics can vouch for:
+    // seen in enough games, and with a score whose lower confidence bound still beats the
+    // average of every move tried there. A move that merely did well in a few lucky games of
+    // weak self-play is left to the search.
+    BookMove probe(const GameVariant& variant) const {
+        BookMove best;
+        if (!map) return best;
+        std::uint64_t key = variant.positionKey();
+        const BookEntry* first = std::lower_bound(entries, entries + count, key,
+                                                  [](const BookEntry& e, std::uint64_t k) { return e.key < k; });
+        const BookEntry* last = first;
+        double totalGames = 0;
+        double totalPoints = 0;
+        for (; last != entries + count && last->key == key; last++) {
+            totalGames += last->games;
+            totalPoints += last->wins + 0.5 * last->draws;
+        }
+        if (totalGames == 0) return best;
+        double average = totalPoints / totalGames;
+        double bestBound = 0;
+        for (const BookEntry* e = first; e != last; e++) {
+            if (e->games < MIN_GAMES || e->cell >= variant.cellCount() || !variant.isEmpty(e->cell)) continue;
+            double score = (e->wins + 0.5 * e->draws) / e->games;
+            // Two standard errors below the mean (a score's variance is at most 1/4 per game)
+            double bound = score - CONFIDENCE / (2 * std::sqrt(static_cast<double>(e->games)));
+            if (bound <= average) continue;
+            if (best.cell == -1 || bound > bestBound) {
+                best.cell = e->cell;
+                best.games = e->games;
+                best.score = score;
+                bestBound = bound;
+            }
+        }
+        return best;
+    }
+
+private:
+    friend class OpeningBookBuilder;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t entrySize;
+        std::uint64_t entryCount;
+        std::uint64_t reserved;
+    };
+    static constexpr char MAGIC[8] = {'T', 'T', 'T', 'B', 'O', 'O', 'K', '1'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    void* map;
+    std::size_t mappedBytes;
+    const BookEntry* entries;
+    std::size_t count;
+};
+
+// Collects move statistics from finished games and writes them out as a book.
+// One builder per thread; merge them before writing.
+class OpeningBookBuilder {
+public:
+    explicit OpeningBookBuilder(int maxPlies = 8) : plies(maxPlies) {}
+
+    // Function to add the first plies of a game (winner 1 X, 2 O, 0 draw) on a board of the given size
+    void addGame(int boardSize, const std::vector<int>& moves, int winner) {
+        std::uint64_t key = zobrist::root(boardSize);
+        CellState player = X_PLAYER;
+        for (int ply = 0; ply < plies && ply < static_cast<int>(moves.size()); ply++) {
+            Stats& stats = table[Slot{key, moves[ply]}];
+            stats.games++;
+            if (winner == 0) stats.draws++;
+            else if (winner == static_cast<int>(player)) stats.wins++;
+            key ^= zobrist::piece(boardSize, moves[ply], player);
+            player = (player == X_PLAYER) ? O_PLAYER : X_PLAYER;
+        }
+    }
+    void merge(const OpeningBookBuilder& other) {
+        for (const auto& [slot, stats] : other.table) {
+            Stats& mine = table[slot];
+            mine.games += stats.games;
+            mine.wins += stats.wins;
+            mine.draws += stats.draws;
+        }
+    }
+
+    // Function to write the book, keeping moves seen in at least minGames games; returns entries written or -1
+    long long write(const std::string& path, std::uint32_t minGames = OpeningBook::MIN_GAMES) const {
+        std::vector<BookEntry> entries;
+        entries.reserve(table.size());
+        for (const auto& [slot, stats] : table) {
+            if (stats.games < minGames) continue;
+            BookEntry entry;
+            entry.key = slot.key;
+            entry.cell = static_cast<std::uint16_t>(slot.cell);
+            entry.reserved = 0;
+            entry.games = stats.games;
+            entry.wins = stats.wins;
+            entry.draws = stats.draws;
+            entries.push_back(entry);
+        }
+        std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b) {
+            return a.key != b.key ? a.key < b.key : a.cell < b.cell;
+        });
+        OpeningBook::Header header = {};
+        std::memcpy(header.magic, OpeningBook::MAGIC, sizeof(header.magic));
+        header.version = OpeningBook::VERSION;
+        header.entrySize = sizeof(BookEntry);
+        header.entryCount = entries.size();
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return -1;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) == entries.size();
+        ok = std::fclose(file) == 0 && ok;
+        return ok ? static_cast<long long>(entries.size()) : -1;
+    }
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        int cell;
+        bool operator==(const Slot& other) const { return key == other.key && cell == other.cell; }
+    };
+    struct SlotHash {
+        std::size_t operator()(const Slot& slot) const { return static_cast<std::size_t>(slot.key ^ zobrist::mix(slot.cell)); }
+    };
+    struct Stats {
+        std::uint32_t games = 0;
+        std::uint32_t wins = 0;
+        std::uint32_t draws = 0;
+    };
+
+    int plies;
+    std::unordered_map<Slot, Stats, SlotHash> table;
+};
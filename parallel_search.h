@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+
+#include "search.h"
+#include "thread_pool.h"
+
+// Parallel alpha-beta using Young Brothers Wait. At every node deep enough to be
+// worth splitting, the first (eldest) move is searched alone to establish a bound;
+// the younger brothers are then searched as pool tasks, each on its own copy of
+// the position, sharing the node's alpha. A beta cutoff in any of them aborts the rest.
+// All threads share one lock-free transposition table.
+template <class BoardT>
+class ParallelSearch {
+public:
+    using Mask = typename BoardT::Mask;
+    using Tracker = LineTracker<BoardT::SIZE, BoardT::WIN_LENGTH>;
+    static constexpr int CELLS = BoardT::CELLS;
+    static constexpr int MIN_SPLIT_DEPTH = 2;
+
+    explicit ParallelSearch(ThreadPool& p) : pool(p) { clearHistory(); }
+
+    // Function to share a transposition table between the searching threads (nullptr for none)
+    void setTable(TranspositionTable* transpositions) { table = transpositions; }
+
+    // Number of threads searching: the pool's workers plus the caller
+    int threadCount() const { return pool.size() + 1; }
+
+    // Function to forget move-ordering statistics between games
+    void clearHistory() {
+        for (auto& plyKillers : killers) {
+            for (auto& killer : plyKillers) killer.store(-1, std::memory_order_relaxed);
+        }
+        for (auto& side : history) {
+            for (auto& entry : side) entry.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Function to search the position for the side to move within the given limits
+    SearchResult search(const BoardT& root, const SearchLimits& limits) {
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result;
+        CellState toMove = root.sideToMove();
+        int remaining = CELLS - root.moveCount();
+
+        if (root.isTerminal() || remaining == 0) return result;
+        if (probeSolvedRoot(root, limits, result)) return result;
+
+        nodes = 0;
+        stopped = false;
+        nodeLimit = limits.maxNodes;
+        hasDeadline = limits.timeBudget.count() > 0;
+        deadline = start + limits.timeBudget;
+        abortFlag = limits.abortFlag;
+        rootBest = -1;
+        TTCounters tableBefore;
+        if (table) {
+            table->newSearch();
+            tableBefore = table->stats();
+        }
+
+        Tracker position(root);
+        int maxDepth = std::min(limits.maxDepth, remaining);
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            NodeCounter counter;
+            int score = negamax(position, toMove, depth, 0, -WIN_SCORE, WIN_SCORE, nullptr, counter);
+            flush(counter);
+            if (stopped) break;
+            result.bestCell = rootBest;
+            result.score = score;
+            result.depth = depth;
+            if (std::abs(score) >= WIN_THRESHOLD || depth == remaining) {
+                result.exact = true;
+                break;
+            }
+        }
+        if (result.bestCell == -1) {
+            result.bestCell = (rootBest != -1) ? rootBest : candidateMoves(root).lowest();
+        }
+
+        result.nodes = nodes;
+        if (table) result.table = table->stats().since(tableBefore);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    // State shared by the younger brothers searched in parallel under one node
+    struct SplitPoint {
+        std::mutex mutex;
+        std::atomic<int> alpha;
+        int beta;
+        int bestScore;
+        int bestMove;
+        std::atomic<bool> cutoff;
+        const SplitPoint* parent;
+    };
+
+    // Nodes and table use are counted per task and folded into the shared totals in batches
+    struct NodeCounter {
+        long long local = 0;
+        TTCounters table;
+    };
+
+    void countNode(NodeCounter& counter) {
+        if (++counter.local >= 256) flush(counter);
+    }
+    // Function to publish a task's node count and check the node and time budgets and the
+    // caller's abort flag, so an aborted iteration is never taken for a finished one
+    void flush(NodeCounter& counter) {
+        long long total = nodes.fetch_add(counter.local, std::memory_order_relaxed) + counter.local;
+        counter.local = 0;
+        if (table) {
+            table->account(counter.table);
+            counter.table = TTCounters();
+        }
+        if ((nodeLimit > 0 && total >= nodeLimit) || (hasDeadline && std::chrono::steady_clock::now() >= deadline) ||
+            (abortFlag && abortFlag->load(std::memory_order_relaxed))) {
+            stopped = true;
+        }
+    }
+
+    // True when the search was stopped or any enclosing split point has already cut off
+    bool aborted(const SplitPoint* split) const {
+        if (stopped.load(std::memory_order_relaxed)) return true;
+        if (abortFlag && abortFlag->load(std::memory_order_relaxed)) return true;
+        for (const SplitPoint* s = split; s; s = s->parent) {
+            if (s->cutoff.load(std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    int orderMoves(const BoardT& board, CellState toMove, int ply, int tableMove, int moves[CELLS]) const {
+        int scores[CELLS];
+        int count = 0;
+        Mask candidates = candidateMoves(board);
+        int killer0 = killers[ply][0].load(std::memory_order_relaxed);
+        int killer1 = killers[ply][1].load(std::memory_order_relaxed);
+        while (candidates.any()) {
+            int cell = candidates.popLowest();
+            int score = history[toMove - 1][cell].load(std::memory_order_relaxed);
+            if (cell == killer0) score += 1 << 20;
+            else if (cell == killer1) score += 1 << 19;
+            if (ply == 0 && cell == rootBest) score += 1 << 24;
+            if (cell == tableMove) score += 1 << 25;
+            moves[count] = cell;
+            scores[count] = score;
+            count++;
+        }
+        for (int i = 1; i < count; i++) {
+            int move = moves[i];
+            int score = scores[i];
+            int j = i - 1;
+            while (j >= 0 && scores[j] < score) {
+                moves[j + 1] = moves[j];
+                scores[j + 1] = scores[j];
+                j--;
+            }
+            moves[j + 1] = move;
+            scores[j + 1] = score;
+        }
+        return count;
+    }
+
+    void recordCutoff(int ply, CellState toMove, int cell, int depth) {
+        if (killers[ply][0].load(std::memory_order_relaxed) != cell) {
+            killers[ply][1].store(killers[ply][0].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            killers[ply][0].store(cell, std::memory_order_relaxed);
+        }
+        history[toMove - 1][cell].fetch_add(depth * depth, std::memory_order_relaxed);
+    }
+
+    // Function to store a node's result, with its bound taken from the window it was searched with
+    void storeResult(const Tracker& position, int ply, int depth, int bestScore, int bestMove, int alpha, int beta,
+                     NodeCounter& counter) {
+        if (!table) return;
+        TTEntry entry;
+        entry.score = scoreToTable(bestScore, ply);
+        entry.move = bestMove;
+        entry.depth = depth;
+        entry.bound = (bestScore <= alpha) ? TT_UPPER : (bestScore >= beta) ? TT_LOWER : TT_EXACT;
+        table->store(position.key(), entry, counter.table);
+    }
+
+    int negamax(Tracker& position, CellState toMove, int depth, int ply, int alpha, int beta,
+                const SplitPoint* split, NodeCounter& counter) {
+        countNode(counter);
+        if (aborted(split)) return 0;
+        if (position.hasWin(opponentOf(toMove))) return -(WIN_SCORE - ply);
+        if (position.position().isFull()) return 0;
+        int winningCell = position.completingCell(toMove);
+        if (winningCell != -1) {
+            if (ply == 0) rootBest = winningCell;
+            return WIN_SCORE - ply - 1;
+        }
+        if (depth == 0) return evaluatePosition(position, toMove);
+
+        alpha = std::max(alpha, -(WIN_SCORE - ply));
+        beta = std::min(beta, WIN_SCORE - ply - 1);
+        if (alpha >= beta) return alpha;
+
+        int tableMove = -1;
+        TTEntry entry;
+        if (table && table->probe(position.key(), entry, counter.table)) {
+            tableMove = entry.move;
+            if (ply > 0 && entry.depth >= depth) {
+                int stored = scoreFromTable(entry.score, ply);
+                if (entry.bound == TT_EXACT) return stored;
+                if (entry.bound == TT_LOWER && stored >= beta) return stored;
+                if (entry.bound == TT_UPPER && stored <= alpha) return stored;
+            }
+        }
+        int originalAlpha = alpha;
+
+        int moves[CELLS];
+        int count = orderMoves(position.position(), toMove, ply, tableMove, moves);
+        CellState opponent = opponentOf(toMove);
+
+        // Eldest brother (or the whole node when it is too shallow to split) searched in place
+        int bestScore = -WIN_SCORE;
+        int bestMove = -1;
+        int serialCount = (depth < MIN_SPLIT_DEPTH) ? count : 1;
+        for (int i = 0; i < serialCount; i++) {
+            int cell = moves[i];
+            position.make(cell, toMove);
+            int score = -negamax(position, opponent, depth - 1, ply + 1, -beta, -alpha, split, counter);
+            position.unmake(cell);
+            if (aborted(split)) return 0;
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = cell;
+            }
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) {
+                recordCutoff(ply, toMove, cell, depth);
+                if (ply == 0) rootBest = bestMove;
+                storeResult(position, ply, depth, bestScore, bestMove, originalAlpha, beta, counter);
+                return bestScore;
+            }
+        }
+
+        if (serialCount < count) {
+            SplitPoint sp;
+            sp.alpha = alpha;
+            sp.beta = beta;
+            sp.bestScore = bestScore;
+            sp.bestMove = bestMove;
+            sp.cutoff = false;
+            sp.parent = split;
+            {
+                TaskGroup group(pool);
+                for (int i = serialCount; i < count; i++) {
+                    int cell = moves[i];
+                    group.run([this, &sp, &position, cell, toMove, opponent, depth, ply]() {
+                        if (aborted(&sp)) return;
+                        // Each younger brother searches its own copy of the position
+                        Tracker child = position;
+                        child.make(cell, toMove);
+                        NodeCounter taskCounter;
+                        int score = -negamax(child, opponent, depth - 1, ply + 1, -sp.beta, -sp.alpha.load(), &sp, taskCounter);
+                        flush(taskCounter);
+                        if (aborted(&sp)) return;
+
+                        std::lock_guard<std::mutex> lock(sp.mutex);
+                        if (score > sp.bestScore) {
+                            sp.bestScore = score;
+                            sp.bestMove = cell;
+                        }
+                        if (score > sp.alpha.load()) sp.alpha = score;
+                        if (sp.alpha.load() >= sp.beta) {
+                            recordCutoff(ply, toMove, cell, depth);
+                            sp.cutoff = true;
+                        }
+                    });
+                }
+                group.wait();
+            }
+            if (aborted(split)) return 0;
+            bestScore = sp.bestScore;
+            bestMove = sp.bestMove;
+        }
+
+        if (ply == 0) rootBest = bestMove;
+        storeResult(position, ply, depth, bestScore, bestMove, originalAlpha, beta, counter);
+        return bestScore;
+    }
+
+    ThreadPool& pool;
+    TranspositionTable* table = nullptr;
+    std::atomic<int> killers[MAX_PLY][2];
+    std::atomic<int> history[2][CELLS];
+    int rootBest = -1;
+    std::atomic<long long> nodes{0};
+    long long nodeLimit = 0;
+    std::atomic<bool> stopped{false};
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    const std::atomic<bool>* abortFlag = nullptr;
+};
+
+// Parallel versus single-threaded timings of the same fixed-depth search
+struct SpeedupReport {
+    int depth = 0;
+    int threads = 1;
+    long long sequentialNodes = 0;
+    long long parallelNodes = 0;
+    double sequentialMs = 0;
+    double parallelMs = 0;
+    double speedup = 0;
+};
+
+// Function to measure the parallel engine's speedup over AlphaBetaSearch on one position
+template <class BoardT>
+SpeedupReport measureSpeedup(const BoardT& position, int depth, ThreadPool& pool) {
+    SearchLimits limits;
+    limits.maxDepth = depth;
+    limits.useSolvedTable = false;
+
+    AlphaBetaSearch<BoardT> sequential;
+    SearchResult single = sequential.search(position, limits);
+    ParallelSearch<BoardT> parallel(pool);
+    SearchResult multi = parallel.search(position, limits);
+
+    SpeedupReport report;
+    report.depth = depth;
+    report.threads = parallel.threadCount();
+    report.sequentialNodes = single.nodes;
+    report.parallelNodes = multi.nodes;
+    report.sequentialMs = single.elapsedMs;
+    report.parallelMs = multi.elapsedMs;
+    report.speedup = (multi.elapsedMs > 0) ? single.elapsedMs / multi.elapsedMs : 0;
+    return report;
+}
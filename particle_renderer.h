@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "particle_system.h"
+
+// Draws every particle of a ParticleSystem as a textured quad in a single draw call.
+// The vertex array persists across frames and only grows; texture coordinates are
+// written once per slot, so a frame only rewrites positions and colours.
+class ParticleRenderer {
+public:
+    // Quad size, matching the 3px-radius circles particles used to be drawn with
+    static constexpr float SIZE = 6.0f;
+    static constexpr unsigned TEXTURE_SIZE = 16;
+
+    ParticleRenderer() : vertices(sf::Quads), slots(0) {
+        createDotTexture();
+    }
+
+    // Function to draw all live particles onto the target, lead seconds along their paths past
+    // the last simulation step (particles move in straight lines, so this is exact)
+    void draw(sf::RenderTarget& target, const ParticleSystem& particles, float lead = 0.0f) {
+        std::size_t count = particles.size();
+        if (count == 0) return;
+        reserve(count);
+
+        const float* x = particles.positionsX();
+        const float* y = particles.positionsY();
+        const float* vx = particles.velocitiesX();
+        const float* vy = particles.velocitiesY();
+        const std::uint32_t* rgb = particles.colors();
+        const std::uint8_t* alpha = particles.alphas();
+        // sf::VertexArray stores its vertices contiguously
+        sf::Vertex* quads = &vertices[0];
+        for (std::size_t i = 0; i < count; i++) {
+            sf::Color color(static_cast<sf::Uint8>(rgb[i] >> 16), static_cast<sf::Uint8>(rgb[i] >> 8),
+                            static_cast<sf::Uint8>(rgb[i]), alpha[i]);
+            sf::Vertex* quad = quads + i * 4;
+            float left = x[i] + vx[i] * lead;
+            float top = y[i] + vy[i] * lead;
+            quad[0].position = sf::Vector2f(left, top);
+            quad[1].position = sf::Vector2f(left + SIZE, top);
+            quad[2].position = sf::Vector2f(left + SIZE, top + SIZE);
+            quad[3].position = sf::Vector2f(left, top + SIZE);
+            quad[0].color = color;
+            quad[1].color = color;
+            quad[2].color = color;
+            quad[3].color = color;
+        }
+        target.draw(quads, count * 4, sf::Quads, sf::RenderStates(&dot));
+    }
+
+private:
+    // Function to grow the vertex array to hold count particles, filling in the new texture coordinates
+    void reserve(std::size_t count) {
+        if (count <= slots) return;
+        std::size_t newSlots = std::max(count, slots * 2);
+        vertices.resize(newSlots * 4);
+        const float edge = static_cast<float>(TEXTURE_SIZE);
+        for (std::size_t i = slots; i < newSlots; i++) {
+            vertices[i * 4].texCoords = sf::Vector2f(0, 0);
+            vertices[i * 4 + 1].texCoords = sf::Vector2f(edge, 0);
+            vertices[i * 4 + 2].texCoords = sf::Vector2f(edge, edge);
+            vertices[i * 4 + 3].texCoords = sf::Vector2f(0, edge);
+        }
+        slots = newSlots;
+    }
+
+    // Function to build a white disc with a soft edge; vertex colours tint it per particle
+    void createDotTexture() {
+        sf::Image image;
+        image.create(TEXTURE_SIZE, TEXTURE_SIZE, sf::Color(255, 255, 255, 0));
+        float radius = TEXTURE_SIZE / 2.0f;
+        for (unsigned row = 0; row < TEXTURE_SIZE; row++) {
+            for (unsigned col = 0; col < TEXTURE_SIZE; col++) {
+                float dx = col + 0.5f - radius;
+                float dy = row + 0.5f - radius;
+                float coverage = std::min(std::max(radius - std::sqrt(dx * dx + dy * dy), 0.0f), 1.0f);
+                image.setPixel(col, row, sf::Color(255, 255, 255, static_cast<sf::Uint8>(coverage * 255)));
+            }
+        }
+        dot.loadFromImage(image);
+        dot.setSmooth(true);
+    }
+
+    sf::Texture dot;
+    sf::VertexArray vertices;
+    std::size_t slots;
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// Structure-of-arrays particle pool. Every attribute lives in its own 32-byte aligned
+// array, so update() integrates positions and fades alpha eight particles at a time
+// with AVX, four with SSE2, or one at a time on other targets. All arrays share one
+// allocation that grows by doubling and is kept between bursts: spawning never drops
+// particles and only allocates when a burst is bigger than any before it.
+class ParticleSystem {
+public:
+    static constexpr std::size_t ALIGNMENT = 32;
+    // Capacity is kept a multiple of this so the vector loops never need a scalar tail
+    static constexpr std::size_t LANES = 8;
+
+    explicit ParticleSystem(std::size_t initialCapacity = 256) { reserve(initialCapacity); }
+    ~ParticleSystem() { release(); }
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+
+    // Function to make room for at least n particles without further allocation
+    void reserve(std::size_t n) {
+        if (n <= cap) return;
+        std::size_t newCap = std::max<std::size_t>(cap * 2, LANES);
+        while (newCap < n) newCap *= 2;
+        newCap = (newCap + LANES - 1) / LANES * LANES;
+
+        Storage next = allocate(newCap);
+        if (count > 0) {
+            std::memcpy(next.x, x, count * sizeof(float));
+            std::memcpy(next.y, y, count * sizeof(float));
+            std::memcpy(next.vx, vx, count * sizeof(float));
+            std::memcpy(next.vy, vy, count * sizeof(float));
+            std::memcpy(next.life, life, count * sizeof(float));
+            std::memcpy(next.invMaxLife, invMaxLife, count * sizeof(float));
+            std::memcpy(next.rgb, rgb, count * sizeof(std::uint32_t));
+            std::memcpy(next.alpha, alpha, count * sizeof(std::uint8_t));
+        }
+        release();
+        adopt(next, newCap);
+    }
+
+    // Function to add a particle; rgb is 0xRRGGBB and the particle fades out over lifetime seconds
+    void spawn(float px, float py, float velX, float velY, std::uint32_t color, float lifetime) {
+        if (lifetime <= 0) return;
+        if (count == cap) reserve(cap + 1);
+        x[count] = px;
+        y[count] = py;
+        vx[count] = velX;
+        vy[count] = velY;
+        life[count] = lifetime;
+        invMaxLife[count] = 1.0f / lifetime;
+        rgb[count] = color;
+        alpha[count] = 255;
+        count++;
+    }
+
+    void clear() { count = 0; }
+
+    // Function to advance every particle by deltaTime and drop the ones that have faded out
+    void update(float deltaTime) {
+        std::size_t firstDead = integrate(deltaTime);
+        if (firstDead < count) removeDead(firstDead);
+    }
+
+    // Read-only views for rendering; index i of each array belongs to the same particle
+    const float* positionsX() const { return x; }
+    const float* positionsY() const { return y; }
+    const float* velocitiesX() const { return vx; }
+    const float* velocitiesY() const { return vy; }
+    const std::uint32_t* colors() const { return rgb; }
+    const std::uint8_t* alphas() const { return alpha; }
+
+private:
+    struct Storage {
+        void* block;
+        float* x;
+        float* y;
+        float* vx;
+        float* vy;
+        float* life;
+        float* invMaxLife;
+        std::uint32_t* rgb;
+        std::uint8_t* alpha;
+    };
+
+    // Function to carve the eight attribute arrays out of one zeroed, aligned block
+    static Storage allocate(std::size_t n) {
+        std::size_t floatBytes = n * sizeof(float);
+        std::size_t bytes = 7 * floatBytes + n * sizeof(std::uint8_t);
+        char* block = static_cast<char*>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+        std::memset(block, 0, bytes);
+        Storage s;
+        s.block = block;
+        s.x = reinterpret_cast<float*>(block);
+        s.y = reinterpret_cast<float*>(block + floatBytes);
+        s.vx = reinterpret_cast<float*>(block + 2 * floatBytes);
+        s.vy = reinterpret_cast<float*>(block + 3 * floatBytes);
+        s.life = reinterpret_cast<float*>(block + 4 * floatBytes);
+        s.invMaxLife = reinterpret_cast<float*>(block + 5 * floatBytes);
+        s.rgb = reinterpret_cast<std::uint32_t*>(block + 6 * floatBytes);
+        s.alpha = reinterpret_cast<std::uint8_t*>(block + 7 * floatBytes);
+        return s;
+    }
+
+    void adopt(const Storage& s, std::size_t n) {
+        block = s.block;
+        x = s.x;
+        y = s.y;
+        vx = s.vx;
+        vy = s.vy;
+        life = s.life;
+        invMaxLife = s.invMaxLife;
+        rgb = s.rgb;
+        alpha = s.alpha;
+        cap = n;
+    }
+
+    void release() {
+        if (block) ::operator delete(block, std::align_val_t(ALIGNMENT));
+        block = nullptr;
+        cap = 0;
+    }
+
+    // Keeps the dead-lane bits of a vector that belong to live slots (not the padding past count).
+    // The loops run to a multiple of LANES, so a narrower vector can lie wholly in the padding.
+    int liveLanes(int deadBits, std::size_t first, int lanes) const {
+        if (first >= count) return 0;
+        if (first + lanes > count) deadBits &= static_cast<int>((1u << (count - first)) - 1);
+        return deadBits;
+    }
+
+    // Function to move positions along the velocities and recompute alpha = life / maxLife * 255.
+    // Lanes past the last particle hold stale but finite values, so whole vectors are processed.
+    // Returns the index of the first particle that died (count if none did).
+    std::size_t integrate(float deltaTime) {
+        std::size_t n = (count + LANES - 1) / LANES * LANES;
+        std::size_t firstDead = count;
+#if defined(__AVX__)
+        const __m256 step = _mm256_set1_ps(deltaTime);
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        for (std::size_t i = 0; i < n; i += 8) {
+            _mm256_store_ps(x + i, _mm256_add_ps(_mm256_load_ps(x + i), _mm256_mul_ps(_mm256_load_ps(vx + i), step)));
+            _mm256_store_ps(y + i, _mm256_add_ps(_mm256_load_ps(y + i), _mm256_mul_ps(_mm256_load_ps(vy + i), step)));
+            __m256 remaining = _mm256_sub_ps(_mm256_load_ps(life + i), step);
+            _mm256_store_ps(life + i, remaining);
+            int dead = liveLanes(_mm256_movemask_ps(_mm256_cmp_ps(remaining, zero, _CMP_LE_OQ)), i, 8);
+            if (dead && firstDead == count) firstDead = i + std::countr_zero(static_cast<unsigned>(dead));
+            __m256 fade = _mm256_mul_ps(_mm256_mul_ps(remaining, _mm256_load_ps(invMaxLife + i)), scale);
+            fade = _mm256_min_ps(_mm256_max_ps(fade, zero), scale);
+            __m256i ints = _mm256_cvttps_epi32(fade);
+            __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extractf128_si256(ints, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(alpha + i), _mm_packus_epi16(words, words));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 step = _mm_set1_ps(deltaTime);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 zero = _mm_setzero_ps();
+        for (std::size_t i = 0; i < n; i += 4) {
+            _mm_store_ps(x + i, _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(_mm_load_ps(vx + i), step)));
+            _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(_mm_load_ps(vy + i), step)));
+            __m128 remaining = _mm_sub_ps(_mm_load_ps(life + i), step);
+            _mm_store_ps(life + i, remaining);
+            int dead = liveLanes(_mm_movemask_ps(_mm_cmple_ps(remaining, zero)), i, 4);
+            if (dead && firstDead == count) firstDead = i + std::countr_zero(static_cast<unsigned>(dead));
+            __m128 fade = _mm_mul_ps(_mm_mul_ps(remaining, _mm_load_ps(invMaxLife + i)), scale);
+            fade = _mm_min_ps(_mm_max_ps(fade, zero), scale);
+            __m128i ints = _mm_cvttps_epi32(fade);
+            __m128i words = _mm_packs_epi32(ints, ints);
+            std::int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            std::memcpy(alpha + i, &bytes, sizeof(bytes));
+        }
+#else
+        // The arrays never overlap; local restrict pointers let the compiler vectorise this loop itself
+        float* __restrict px = x;
+        float* __restrict py = y;
+        float* __restrict pl = life;
+        std::uint8_t* __restrict pa = alpha;
+        const float* __restrict pvx = vx;
+        const float* __restrict pvy = vy;
+        const float* __restrict pinv = invMaxLife;
+        for (std::size_t i = 0; i < n; i++) {
+            px[i] += pvx[i] * deltaTime;
+            py[i] += pvy[i] * deltaTime;
+            pl[i] -= deltaTime;
+            float fade = std::min(std::max(pl[i] * pinv[i] * 255.0f, 0.0f), 255.0f);
+            pa[i] = static_cast<std::uint8_t>(static_cast<int>(fade));
+        }
+        // Separate scan so the loop above stays free of branches
+        for (std::size_t i = 0; i < count; i++) {
+            if (life[i] <= 0) {
+                firstDead = i;
+                break;
+            }
+        }
+#endif
+        return firstDead;
+    }
+
+    // Function to drop faded particles by moving the last particle into each hole
+    void removeDead(std::size_t i) {
+        while (i < count) {
+            if (life[i] > 0) {
+                i++;
+                continue;
+            }
+            count--;
+            x[i] = x[count];
+            y[i] = y[count];
+            vx[i] = vx[count];
+            vy[i] = vy[count];
+            life[i] = life[count];
+            invMaxLife[i] = invMaxLife[count];
+            rgb[i] = rgb[count];
+            alpha[i] = alpha[count];
+        }
+    }
+
+    void* block = nullptr;
+    float* x = nullptr;
+    float* y = nullptr;
+    float* vx = nullptr;
+    float* vy = nullptr;
+    float* life = nullptr;
+    float* invMaxLife = nullptr;
+    std::uint32_t* rgb = nullptr;
+    std::uint8_t* alpha = nullptr;
+    std::size_t count = 0;
+    std::size_t cap = 0;
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fixed window of recent samples in milliseconds, summarised as percentiles
+class SampleWindow {
+public:
+    struct Summary {
+        double p50Ms = 0;
+        double p99Ms = 0;
+        double maxMs = 0;
+        std::size_t samples = 0;
+    };
+
+    explicit SampleWindow(std::size_t capacity) : values(capacity, 0.0), next(0), stored(0) {}
+
+    void add(double ms) {
+        values[next] = ms;
+        next = (next + 1) % values.size();
+        if (stored < values.size()) stored++;
+    }
+
+    // Function to compute the percentiles over the stored samples
+    Summary summarize() const {
+        Summary summary;
+        summary.samples = stored;
+        if (stored == 0) return summary;
+        std::vector<double> sorted(values.begin(), values.begin() + stored);
+        std::sort(sorted.begin(), sorted.end());
+        auto rank = [&](double q) { return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(q * sorted.size()))]; };
+        summary.p50Ms = rank(0.50);
+        summary.p99Ms = rank(0.99);
+        summary.maxMs = sorted.back();
+        return summary;
+    }
+
+private:
+    std::vector<double> values;
+    std::size_t next;
+    std::size_t stored;
+};
+
+// Lightweight frame-phase instrumentation. ProfileScope times a block; the profiler keeps
+// the latest duration of each phase, windows of recent frame times and input-to-present
+// latencies for percentiles, and,
+// while tracing, a list of events that can be written out in Chrome's trace-event format
+// (load it in chrome://tracing or Perfetto). When neither timing nor tracing is enabled a
+// scope costs one relaxed atomic load.
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Phases of a frame, plus the AI search that runs on a worker thread. FRAME covers
+    // input, update and render but not the frame rate cap's wait inside present.
+    enum Phase {
+        FRAME,
+        INPUT,
+        UPDATE,
+        RENDER,
+        PRESENT,
+        AI_MOVE,
+        PHASE_COUNT
+    };
+    // Number of recent frames (and inputs) the percentiles are computed over
+    static constexpr std::size_t WINDOW = 240;
+    // Traces stop recording at this many events so a forgotten trace cannot grow without bound
+    static constexpr std::size_t MAX_TRACE_EVENTS = 1 << 20;
+
+    FrameProfiler() : timing(false), tracing(false), origin(Clock::now()), frameTimes(WINDOW), inputLatencies(WINDOW) {
+        for (int i = 0; i < PHASE_COUNT; i++) lastNs[i] = 0;
+    }
+
+    static const char* phaseName(int phase) {
+        switch (phase) {
+            case FRAME: return "frame";
+            case INPUT: return "input";
+            case UPDATE: return "update";
+            case RENDER: return "render";
+            case PRESENT: return "present";
+            default: return "ai move";
+        }
+    }
+
+    void setTiming(bool on) { timing.store(on, std::memory_order_relaxed); }
+    bool isTiming() const { return timing.load(std::memory_order_relaxed); }
+    bool isTracing() const { return tracing.load(std::memory_order_relaxed); }
+    bool active() const { return timing.load(std::memory_order_relaxed) || tracing.load(std::memory_order_relaxed); }
+
+    // Function to start recording trace events, discarding any earlier ones
+    void startTrace() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        events.clear();
+        tracing.store(true, std::memory_order_relaxed);
+    }
+    // Function to stop recording and write the events as trace-event JSON; returns false if the file cannot be written
+    bool stopTrace(const std::string& path) {
+        tracing.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(traceMutex);
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        file << "{\"traceEvents\":[\n";
+        for (std::size_t i = 0; i < events.size(); i++) {
+            const TraceEvent& e = events[i];
+            file << "{\"name\":\"" << phaseName(e.phase) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread
+                 << ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0 << "}"
+                 << (i + 1 < events.size() ? ",\n" : "\n");
+        }
+        file << "],\"displayTimeUnit\":\"ms\"}\n";
+        return true;
+    }
+    std::size_t traceEventCount() {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        return events.size();
+    }
+
+    // Function to record one finished phase; called by ProfileScope from any thread (FRAME from the game loop only)
+    void record(Phase phase, Clock::time_point start, Clock::time_point end) {
+        std::int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        lastNs[phase].store(durationNs, std::memory_order_relaxed);
+        if (phase == FRAME) frameTimes.add(durationNs / 1e6);
+        if (tracing.load(std::memory_order_relaxed)) {
+            TraceEvent event;
+            event.phase = phase;
+            event.thread = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+            event.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin).count();
+            event.durationNs = durationNs;
+            std::lock_guard<std::mutex> lock(traceMutex);
+            if (events.size() < MAX_TRACE_EVENTS) events.push_back(event);
+        }
+    }
+
+    // Latest duration of a phase in milliseconds
+    double lastMs(Phase phase) const { return lastNs[phase].load(std::memory_order_relaxed) / 1e6; }
+
+    // Function to record the time from handling an input event to presenting the frame that shows it
+    void recordInputLatency(Clock::duration latency) {
+        if (active()) inputLatencies.add(std::chrono::duration<double, std::milli>(latency).count());
+    }
+
+    SampleWindow::Summary summarize() const { return frameTimes.summarize(); }
+    SampleWindow::Summary summarizeInputLatency() const { return inputLatencies.summarize(); }
+
+private:
+    struct TraceEvent {
+        Phase phase;
+        std::uint32_t thread;
+        std::int64_t startNs;
+        std::int64_t durationNs;
+    };
+
+    std::atomic<bool> timing;
+    std::atomic<bool> tracing;
+    Clock::time_point origin;
+    std::atomic<std::int64_t> lastNs[PHASE_COUNT];
+    // Only written by the thread that runs the game loop
+    SampleWindow frameTimes;
+    SampleWindow inputLatencies;
+    std::mutex traceMutex;
+    std::vector<TraceEvent> events;
+};
+
+// Times the enclosing block as one phase when the profiler is active
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler& p, FrameProfiler::Phase ph) : profiler(p), phase(ph), on(p.active()) {
+        if (on) start = FrameProfiler::Clock::now();
+    }
+    ~ProfileScope() {
+        if (on) profiler.record(phase, start, FrameProfiler::Clock::now());
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler& profiler;
+    FrameProfiler::Phase phase;
+    bool on;
+    FrameProfiler::Clock::time_point start;
+};
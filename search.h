@@ -0,0 +1,352 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include "board.h"
+#include "line_tracker.h"
+#include "solved_table.h"
+#include "transposition_table.h"
+
+// Scores are from the side to move's point of view. A win found at ply p from
+// the root scores WIN_SCORE - p, so the engine prefers the fastest win and the
+// slowest loss; anything beyond WIN_THRESHOLD is a forced result.
+constexpr int WIN_SCORE = 1000000;
+constexpr int WIN_THRESHOLD = WIN_SCORE - 1000;
+constexpr int MAX_PLY = 256;
+
+// Budget for a single search; zero means unlimited
+struct SearchLimits {
+    int maxDepth = MAX_PLY;
+    long long maxNodes = 0;
+    std::chrono::milliseconds timeBudget{0};
+    bool useSolvedTable = true;
+    const std::atomic<bool>* abortFlag = nullptr;  // set from another thread to stop the search early
+};
+
+// Outcome and statistics of a search
+struct SearchResult {
+    int bestCell = -1;
+    int score = 0;
+    int depth = 0;         // deepest fully completed iteration
+    long long nodes = 0;
+    double elapsedMs = 0;
+    bool exact = false;    // score is the proven game-theoretic value
+    TTCounters table;      // transposition table use during this search
+};
+
+// Win and loss scores count plies from the root; the table stores them counted from the
+// node instead, so they stay right when the position recurs at another ply
+inline int scoreToTable(int score, int ply) {
+    if (score >= WIN_THRESHOLD) return score + ply;
+    if (score <= -WIN_THRESHOLD) return score - ply;
+    return score;
+}
+inline int scoreFromTable(int score, int ply) {
+    if (score >= WIN_THRESHOLD) return score - ply;
+    if (score <= -WIN_THRESHOLD) return score + ply;
+    return score;
+}
+
+// Minimax algorithm without pruning (O maximises), kept as the reference the faster engines are checked against
+template <class BoardT>
+int minimax(BoardT& position, bool isMaximizing) {
+    if (position.checkWin()) {
+        return isMaximizing ? -1 : 1;
+    }
+    if (position.isFull()) {
+        return 0;
+    }
+
+    int bestScore = isMaximizing ? -1000 : 1000;
+    typename BoardT::Mask moves = position.emptyMask();
+
+    while (moves.any()) {
+        int cell = moves.popLowest();
+        position.place(cell, isMaximizing ? O_PLAYER : X_PLAYER);
+        int score = minimax(position, !isMaximizing);
+        position.clear(cell);
+        bestScore = isMaximizing ? std::max(bestScore, score) : std::min(bestScore, score);
+    }
+
+    return bestScore;
+}
+
+// Function to list the moves worth searching: every empty cell on small boards,
+// only cells next to existing pieces on large ones
+template <class BoardT>
+typename BoardT::Mask candidateMoves(const BoardT& position) {
+    using Mask = typename BoardT::Mask;
+    Mask empty = position.emptyMask();
+    if constexpr (BoardT::SIZE <= 5) {
+        return empty;
+    } else {
+        Mask occupied = position.occupiedMask();
+        if (occupied.none()) return Mask::single(BoardT::cellIndex(BoardT::SIZE / 2, BoardT::SIZE / 2));
+        Mask near;
+        while (occupied.any()) near |= BoardT::NEIGHBOURS[occupied.popLowest()];
+        return near & empty;
+    }
+}
+
+// Weight of an open line holding c pieces: 4^(c-1), so each extra piece dominates
+template <int K>
+constexpr std::array<int, K + 1> buildLineWeights() {
+    std::array<int, K + 1> weights{};
+    for (int c = 1; c <= K; c++) weights[c] = 1 << (2 * (c - 1));
+    return weights;
+}
+
+// Static evaluation of a non-terminal leaf: lines still open for one side only, weighted by progress
+template <class BoardT>
+int evaluatePosition(const BoardT& position, CellState toMove) {
+    using Mask = typename BoardT::Mask;
+    static constexpr std::array<int, BoardT::WIN_LENGTH + 1> LINE_WEIGHT = buildLineWeights<BoardT::WIN_LENGTH>();
+    const Mask& ours = position.playerMask(toMove);
+    const Mask& theirs = position.playerMask(opponentOf(toMove));
+    int score = 0;
+    for (const Mask& line : BoardT::WIN_MASKS) {
+        int mine = (ours & line).count();
+        int other = (theirs & line).count();
+        if (other == 0) score += LINE_WEIGHT[mine];
+        if (mine == 0) score -= LINE_WEIGHT[other];
+    }
+    return score;
+}
+
+// The same evaluation read straight from the tracked per-line counts
+template <int N, int K>
+int evaluatePosition(const LineTracker<N, K>& position, CellState toMove) {
+    static constexpr std::array<int, K + 1> LINE_WEIGHT = buildLineWeights<K>();
+    const auto& ours = position.lineCounts(toMove);
+    const auto& theirs = position.lineCounts(opponentOf(toMove));
+    int score = 0;
+    for (int line = 0; line < LineTracker<N, K>::LINE_COUNT; line++) {
+        int mine = ours[line];
+        int other = theirs[line];
+        if (other == 0) score += LINE_WEIGHT[mine];
+        if (mine == 0) score -= LINE_WEIGHT[other];
+    }
+    return score;
+}
+
+// Function to answer the root from the solved 3x3 table when allowed; returns true if it did
+template <class BoardT>
+bool probeSolvedRoot(const BoardT& root, const SearchLimits& limits, SearchResult& result) {
+    if constexpr (std::is_same_v<BoardT, Board>) {
+        if (limits.useSolvedTable) {
+            SolvedMove solved = probeSolvedTable(root);
+            if (solved.cell != -1) {
+                result.bestCell = solved.cell;
+                result.score = solved.value * WIN_SCORE;
+                result.depth = BoardT::CELLS - root.moveCount();
+                result.exact = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Iterative-deepening alpha-beta (negamax) with transposition table, killer and history move ordering
+template <class BoardT>
+class AlphaBetaSearch {
+public:
+    using Mask = typename BoardT::Mask;
+    using Tracker = LineTracker<BoardT::SIZE, BoardT::WIN_LENGTH>;
+    static constexpr int CELLS = BoardT::CELLS;
+
+    AlphaBetaSearch() { clearHistory(); }
+
+    // Function to forget move-ordering statistics between games
+    void clearHistory() {
+        memset(killers, -1, sizeof(killers));
+        memset(history, 0, sizeof(history));
+    }
+    // Function to store and look up positions in a table (nullptr searches without one)
+    void setTable(TranspositionTable* transpositions) { table = transpositions; }
+
+    // Function to search the position for the side to move within the given limits
+    SearchResult search(const BoardT& root, const SearchLimits& limits) {
+        auto start = std::chrono::steady_clock::now();
+        SearchResult result;
+        CellState toMove = root.sideToMove();
+        int remaining = CELLS - root.moveCount();
+
+        if (root.isTerminal() || remaining == 0) return result;
+
+        if (probeSolvedRoot(root, limits, result)) return result;
+
+        nodes = 0;
+        stopped = false;
+        nodeLimit = limits.maxNodes;
+        hasDeadline = limits.timeBudget.count() > 0;
+        deadline = start + limits.timeBudget;
+        rootBest = -1;
+        abortFlag = limits.abortFlag;
+        tableCounters = TTCounters();
+        if (table) table->newSearch();
+
+        position.assign(root);
+        int maxDepth = std::min(limits.maxDepth, remaining);
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            int score = negamax(toMove, depth, 0, -WIN_SCORE, WIN_SCORE);
+            if (stopped) break;
+            result.bestCell = rootBest;
+            result.score = score;
+            result.depth = depth;
+            // A forced result or a search to the end of the game cannot change with more depth
+            if (std::abs(score) >= WIN_THRESHOLD || depth == remaining) {
+                result.exact = true;
+                break;
+            }
+        }
+        // Even an interrupted first iteration must return a legal move
+        if (result.bestCell == -1) {
+            result.bestCell = (rootBest != -1) ? rootBest : candidateMoves(root).lowest();
+        }
+
+        result.nodes = nodes;
+        result.table = tableCounters;
+        if (table) table->account(tableCounters);
+        result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    // Function to check the abort flag and node budget, and the clock every 1024 nodes
+    bool outOfBudget() {
+        if (abortFlag && abortFlag->load(std::memory_order_relaxed)) return true;
+        if (nodeLimit > 0 && nodes >= nodeLimit) return true;
+        if (hasDeadline && (nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) return true;
+        return false;
+    }
+
+    // Function to order moves: previous best at the root, then killers, then history
+    int orderMoves(const BoardT& board, CellState toMove, int ply, int tableMove, int moves[CELLS]) const {
+        int scores[CELLS];
+        int count = 0;
+        Mask candidates = candidateMoves(board);
+        while (candidates.any()) {
+            int cell = candidates.popLowest();
+            int score = history[toMove - 1][cell];
+            if (cell == killers[ply][0]) score += 1 << 20;
+            else if (cell == killers[ply][1]) score += 1 << 19;
+            if (ply == 0 && cell == rootBest) score += 1 << 24;
+            if (cell == tableMove) score += 1 << 25;
+            moves[count] = cell;
+            scores[count] = score;
+            count++;
+        }
+        // Insertion sort: candidate lists are short
+        for (int i = 1; i < count; i++) {
+            int move = moves[i];
+            int score = scores[i];
+            int j = i - 1;
+            while (j >= 0 && scores[j] < score) {
+                moves[j + 1] = moves[j];
+                scores[j + 1] = scores[j];
+                j--;
+            }
+            moves[j + 1] = move;
+            scores[j + 1] = score;
+        }
+        return count;
+    }
+
+    int negamax(CellState toMove, int depth, int ply, int alpha, int beta) {
+        nodes++;
+        if (outOfBudget()) {
+            stopped = true;
+            return 0;
+        }
+        // Only the opponent's last move can have completed a line
+        if (position.hasWin(opponentOf(toMove))) return -(WIN_SCORE - ply);
+        if (position.position().isFull()) return 0;
+        // A line one piece short is won on this move, whatever the remaining depth
+        int winningCell = position.completingCell(toMove);
+        if (winningCell != -1) {
+            if (ply == 0) rootBest = winningCell;
+            return WIN_SCORE - ply - 1;
+        }
+        if (depth == 0) return evaluatePosition(position, toMove);
+
+        // Mate-distance pruning: no result here can beat a win already found closer to the root
+        alpha = std::max(alpha, -(WIN_SCORE - ply));
+        beta = std::min(beta, WIN_SCORE - ply - 1);
+        if (alpha >= beta) return alpha;
+
+        // A stored result searched at least this deep settles the node; any stored move is tried first
+        int tableMove = -1;
+        TTEntry entry;
+        if (table && table->probe(position.key(), entry, tableCounters)) {
+            tableMove = entry.move;
+            if (ply > 0 && entry.depth >= depth) {
+                int stored = scoreFromTable(entry.score, ply);
+                if (entry.bound == TT_EXACT) return stored;
+                if (entry.bound == TT_LOWER && stored >= beta) return stored;
+                if (entry.bound == TT_UPPER && stored <= alpha) return stored;
+            }
+        }
+        int originalAlpha = alpha;
+
+        int moves[CELLS];
+        int count = orderMoves(position.position(), toMove, ply, tableMove, moves);
+        int bestScore = -WIN_SCORE;
+        int bestMove = -1;
+
+        for (int i = 0; i < count; i++) {
+            int cell = moves[i];
+            position.make(cell, toMove);
+            int score = -negamax(opponentOf(toMove), depth - 1, ply + 1, -beta, -alpha);
+            position.unmake(cell);
+            if (stopped) return 0;
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = cell;
+                if (ply == 0) rootBest = cell;
+            }
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) {
+                if (killers[ply][0] != cell) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = cell;
+                }
+                history[toMove - 1][cell] += depth * depth;
+                break;
+            }
+        }
+
+        if (table) {
+            TTEntry result;
+            result.score = scoreToTable(bestScore, ply);
+            result.move = bestMove;
+            result.depth = depth;
+            result.bound = (bestScore <= originalAlpha) ? TT_UPPER : (bestScore >= beta) ? TT_LOWER : TT_EXACT;
+            table->store(position.key(), result, tableCounters);
+        }
+        return bestScore;
+    }
+
+    // Position being searched, with per-line counts updated by make/unmake
+    Tracker position;
+    TranspositionTable* table = nullptr;
+    TTCounters tableCounters;
+    int killers[MAX_PLY][2];
+    int history[2][CELLS];
+    int rootBest = -1;
+    long long nodes = 0;
+    long long nodeLimit = 0;
+    bool stopped = false;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    const std::atomic<bool>* abortFlag = nullptr;
+};
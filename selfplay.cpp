@@ -0,0 +1,312 @@
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+#include "game_logic.h"
+#include "game_record.h"
+#include "opening_book.h"
+#include "solved_table.h"
+#include "thread_pool.h"
+#include "variant.h"
+
+using namespace std;
+
+// Batch AI-vs-AI self-play without a display. Every thread plays whole games on its
+// own Match with single-threaded engines, which keeps all cores busy with no sharing.
+//
+//   selfplay [--games N] [--x LEVEL] [--o LEVEL] [--board 3x3|4x4|7x7|15x15]
+//            [--threads N] [--seed S] [--hard-nodes N] [--expert-playouts N] [--record FILE]
+//            [--book FILE] [--build-book FILE] [--book-plies N]
+//   selfplay --check-solved
+//
+// LEVEL is easy, medium, hard, expert or 1-4. With --record every game is archived in the
+// compact format of game_record.h (in the order threads finish them). --build-book writes
+// an opening book of the first --book-plies moves of every game; --book lets Hard and
+// Expert play from an existing one. --check-solved compares the compile-time 3x3 table of
+// solved_table.h with the reference minimax on every reachable position and exits non-zero
+// on a mismatch.
+
+struct SelfPlayOptions {
+    long long games = 100000;
+    int xDifficulty = 1;
+    int oDifficulty = 1;
+    int variantIndex = 0;
+    int threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    uint64_t seed = 1;
+    AIBudget budget;
+    string recordPath;
+    string bookPath;
+    string buildBookPath;
+    int bookPlies = 8;
+    bool checkSolved = false;
+};
+
+// Totals of a batch of games
+struct SelfPlayTally {
+    long long games = 0;
+    long long xWins = 0;
+    long long oWins = 0;
+    long long draws = 0;
+    long long moves = 0;
+    TTCounters table;   // transposition table use by the alpha-beta searches
+
+    void add(const SelfPlayTally& other) {
+        games += other.games;
+        xWins += other.xWins;
+        oWins += other.oWins;
+        draws += other.draws;
+        moves += other.moves;
+        table.add(other.table);
+    }
+};
+
+// Function to mix a counter into a well-spread 64-bit value (splitmix64)
+uint64_t mixSeed(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Function to play one game; its random stream depends only on the seed and game number
+void playGame(Match& match, const SelfPlayOptions& options, const OpeningBook* book, long long gameNumber, SelfPlayTally& tally) {
+    uint64_t state = mixSeed(options.seed ^ mixSeed(static_cast<uint64_t>(gameNumber)));
+    match.reset();
+    while (!match.isOver()) {
+        state = mixSeed(state);
+        int difficulty = (match.currentPlayer() == 1) ? options.xDifficulty : options.oDifficulty;
+        AIMove move = chooseAIMove(match.position(), match.currentPiece(), difficulty, options.budget,
+                                   static_cast<unsigned>(state >> 32), static_cast<unsigned>(state), nullptr, book);
+        if (!match.play(move.cell)) break;
+        tally.moves++;
+        tally.table.add(move.search.table);
+    }
+    tally.games++;
+    if (match.winner() == 1) tally.xWins++;
+    else if (match.winner() == 2) tally.oWins++;
+    else tally.draws++;
+}
+
+// Function to parse a difficulty name or number (0 when invalid)
+int parseDifficulty(const string& text) {
+    for (int level = 1; level <= DIFFICULTY_COUNT; level++) {
+        string name = difficultyName(level);
+        transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (text == name || text == to_string(level)) return level;
+    }
+    return 0;
+}
+
+// Function to parse the board name (-1 when invalid)
+int parseVariant(const string& text) {
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        if (text == VARIANTS[i].name) return i;
+    }
+    return -1;
+}
+
+void printUsage() {
+    cerr << "usage: selfplay [--games N] [--x LEVEL] [--o LEVEL] [--board 3x3|4x4|7x7|15x15]\n"
+            "                [--threads N] [--seed S] [--hard-nodes N] [--expert-playouts N] [--record FILE]\n"
+            "                [--book FILE] [--build-book FILE] [--book-plies N]\n"
+            "       selfplay --check-solved\n"
+            "LEVEL is easy, medium, hard, expert or 1-4\n";
+}
+
+// Function to read the command line; returns false on a bad argument
+bool parseOptions(int argc, char** argv, SelfPlayOptions& options) {
+    // Time budgets would make batch results depend on machine load, so searches are bounded by work
+    options.budget.hardTime = chrono::milliseconds(0);
+    options.budget.hardNodes = 20000;
+    options.budget.expertTime = chrono::milliseconds(0);
+    options.budget.expertPlayouts = 2000;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--check-solved") {
+            options.checkSolved = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        if (arg == "--games") options.games = atoll(value.c_str());
+        else if (arg == "--x") options.xDifficulty = parseDifficulty(value);
+        else if (arg == "--o") options.oDifficulty = parseDifficulty(value);
+        else if (arg == "--board") options.variantIndex = parseVariant(value);
+        else if (arg == "--threads") options.threads = atoi(value.c_str());
+        else if (arg == "--seed") options.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--hard-nodes") options.budget.hardNodes = atoll(value.c_str());
+        else if (arg == "--expert-playouts") options.budget.expertPlayouts = atoll(value.c_str());
+        else if (arg == "--record") options.recordPath = value;
+        else if (arg == "--book") options.bookPath = value;
+        else if (arg == "--build-book") options.buildBookPath = value;
+        else if (arg == "--book-plies") options.bookPlies = atoi(value.c_str());
+        else return false;
+    }
+    return options.games > 0 && options.xDifficulty > 0 && options.oDifficulty > 0 &&
+           options.variantIndex >= 0 && options.threads > 0 &&
+           options.budget.hardNodes > 0 && options.budget.expertPlayouts > 0 && options.bookPlies > 0;
+}
+
+// Function to check one position and everything reachable from it against minimax; each
+// position is checked once, however many move orders reach it
+void checkSolvedFrom(Board& position, vector<bool>& visited, int key, long long& checked, long long& mismatches) {
+    if (visited[key]) return;
+    visited[key] = true;
+    if (position.checkWin() || position.isFull()) return;
+
+    CellState side = position.sideToMove();
+    bool oToMove = side == O_PLAYER;
+    // minimax scores for O, the table for the side to move
+    int expected = oToMove ? minimax(position, true) : -minimax(position, false);
+    SolvedMove solvedMove = probeSolvedTable(position);
+    bool ok = solvedMove.cell >= 0 && solvedMove.value == expected && position.at(solvedMove.cell) == EMPTY;
+    if (ok) {
+        // The move must keep the value, not just the value be right
+        position.place(solvedMove.cell, side);
+        int afterMove = position.checkWin() ? 1 : oToMove ? minimax(position, false) : -minimax(position, true);
+        position.clear(solvedMove.cell);
+        ok = afterMove == expected;
+    }
+    checked++;
+    if (!ok) {
+        mismatches++;
+        cerr << "Mismatch at key " << key << ": table says cell " << solvedMove.cell << " value " << solvedMove.value
+             << ", minimax says " << expected << endl;
+    }
+
+    for (int cell = 0; cell < Board::CELLS; cell++) {
+        if (position.at(cell) != EMPTY) continue;
+        position.place(cell, side);
+        checkSolvedFrom(position, visited, key + solved::POW3[cell] * side, checked, mismatches);
+        position.clear(cell);
+    }
+}
+
+// Function to check the solved 3x3 table against minimax; returns the process exit code
+int checkSolvedTable() {
+    Board position;
+    vector<bool> visited(solved::STATE_COUNT, false);
+    long long checked = 0;
+    long long mismatches = 0;
+    checkSolvedFrom(position, visited, 0, checked, mismatches);
+    cout << "Solved table: " << solved::ENTRY_COUNT << " entries, " << checked << " positions checked against minimax, "
+         << mismatches << " mismatches" << endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    SelfPlayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    if (options.checkSolved) return checkSolvedTable();
+
+    cout << "Self-play: " << options.games << " games on " << VARIANTS[options.variantIndex].name
+         << ", X " << difficultyName(options.xDifficulty) << " vs O " << difficultyName(options.oDifficulty)
+         << ", " << options.threads << " threads" << endl;
+
+    GameRecordWriter recorder;
+    if (!options.recordPath.empty() && !recorder.open(options.recordPath, options.variantIndex)) {
+        cerr << "Could not create " << options.recordPath << endl;
+        return 1;
+    }
+    OpeningBook book;
+    if (!options.bookPath.empty() && !book.open(options.bookPath)) {
+        cerr << "Could not open opening book " << options.bookPath << endl;
+        return 1;
+    }
+    const OpeningBook* playBook = book.isOpen() ? &book : nullptr;
+    bool buildBook = !options.buildBookPath.empty();
+    OpeningBookBuilder bookBuilder(options.bookPlies);
+
+    // Threads encode games into their own buffer and hand it to the writer when it fills up
+    const size_t RECORD_BATCH = 1 << 16;
+    mutex recorderMutex;
+
+    // Games are handed out in small chunks so fast and slow games balance across threads
+    const long long CHUNK = 64;
+    atomic<long long> nextGame(0);
+    SelfPlayTally total;
+    mutex totalMutex;
+
+    auto start = chrono::steady_clock::now();
+    {
+        ThreadPool pool(options.threads - 1);
+        TaskGroup group(pool);
+        auto worker = [&]() {
+            Match match(options.variantIndex);
+            SelfPlayTally tally;
+            OpeningBookBuilder localBook(options.bookPlies);
+            vector<unsigned char> encoded(options.recordPath.empty() ? 0 : RECORD_BATCH + record_format::MAX_RECORD_BYTES);
+            size_t encodedBytes = 0;
+            long long encodedGames = 0;
+            auto handOver = [&]() {
+                lock_guard<mutex> lock(recorderMutex);
+                recorder.appendEncoded(encoded.data(), encodedBytes, encodedGames);
+                encodedBytes = 0;
+                encodedGames = 0;
+            };
+            for (;;) {
+                long long first = nextGame.fetch_add(CHUNK);
+                if (first >= options.games) break;
+                long long last = min(options.games, first + CHUNK);
+                for (long long game = first; game < last; game++) {
+                    playGame(match, options, playBook, game, tally);
+                    if (buildBook) localBook.addGame(match.position().size(), match.moves(), match.winner());
+                    if (encoded.empty()) continue;
+                    const vector<int>& moves = match.moves();
+                    encodedBytes += record_format::encode(match.position().size(), match.winner(), moves.data(),
+                                                          static_cast<int>(moves.size()), encoded.data() + encodedBytes);
+                    encodedGames++;
+                    if (encodedBytes >= RECORD_BATCH) handOver();
+                }
+            }
+            if (encodedGames > 0) handOver();
+            lock_guard<mutex> lock(totalMutex);
+            total.add(tally);
+            if (buildBook) bookBuilder.merge(localBook);
+        };
+        for (int t = 1; t < options.threads; t++) group.run(worker);
+        worker();
+        group.wait();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!options.recordPath.empty()) {
+        long long recorded = recorder.written();
+        if (!recorder.close()) {
+            cerr << "Could not write " << options.recordPath << endl;
+            return 1;
+        }
+        cout << "Recorded " << recorded << " games to " << options.recordPath << endl;
+    }
+    if (buildBook) {
+        long long entries = bookBuilder.write(options.buildBookPath);
+        if (entries < 0) {
+            cerr << "Could not write " << options.buildBookPath << endl;
+            return 1;
+        }
+        cout << "Opening book: " << entries << " moves written to " << options.buildBookPath << endl;
+    }
+
+    auto percent = [&](long long count) { return 100.0 * count / max(1LL, total.games); };
+    cout.setf(ios::fixed);
+    cout.precision(2);
+    cout << "X wins:  " << total.xWins << " (" << percent(total.xWins) << "%)\n"
+         << "O wins:  " << total.oWins << " (" << percent(total.oWins) << "%)\n"
+         << "Draws:   " << total.draws << " (" << percent(total.draws) << "%)\n"
+         << "Time:    " << seconds << " s | " << (seconds > 0 ? total.games / seconds : 0) << " games/s | "
+         << static_cast<double>(total.moves) / max(1LL, total.games) << " moves/game" << endl;
+    if (total.table.probes > 0) {
+        cout << "Table:   " << total.table.probes << " probes | " << 100 * total.table.hitRate() << "% hits | "
+             << 100 * total.table.collisionRate() << "% of stores evicted another position" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,496 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "game_logic.h"
+#include "match_protocol.h"
+#include "thread_pool.h"
+#include "variant.h"
+
+using namespace std;
+
+// Headless match server (Linux). One thread runs an epoll loop over every client socket
+// and holds all matches; AI moves run on a shared ThreadPool and come back through an
+// eventfd. A match is only its board, difficulty and move list: the loop and every
+// worker keep one engine per board size and replay a match's moves into it when needed,
+// so thousands of concurrent matches cost a few dozen bytes each.
+//
+//   server [--port N] [--workers N] [--hard-nodes N] [--expert-playouts N]
+//
+// The protocol is described in match_protocol.h; loadgen.cpp is a matching client.
+
+struct ServerOptions {
+    uint16_t port = protocol::DEFAULT_PORT;
+    int workers = max(1, static_cast<int>(thread::hardware_concurrency()) - 1);
+    AIBudget budget;
+};
+
+// One game in progress on a connection
+struct ServerMatch {
+    uint8_t variant = 0;
+    uint8_t difficulty = 1;
+    uint8_t status = protocol::ONGOING;
+    bool aiThinking = false;
+    // Bumped when the id is reused, so a late AI move for an earlier match is dropped
+    uint32_t epoch = 0;
+    vector<uint8_t> moves;
+};
+
+struct Connection {
+    int fd = -1;
+    vector<unsigned char> in;
+    vector<unsigned char> out;
+    size_t outSent = 0;
+    bool watchingWrites = false;
+    bool readsPaused = false;
+    unordered_map<uint32_t, ServerMatch> matches;
+};
+
+// AI move computed by a worker, waiting to be applied by the loop
+struct AICompletion {
+    uint64_t connection;
+    uint32_t matchId;
+    uint32_t epoch;
+    int cell;
+    uint8_t status;
+};
+
+// Limit on matches per connection, so one client cannot exhaust the server's memory
+const size_t MAX_MATCHES_PER_CONNECTION = 1 << 16;
+// Unsent replies past which a connection is not read until the client catches up, for the
+// same reason: a client that sends but never reads would otherwise grow its queue forever.
+// Replies already owed (one read's worth of messages, AI moves in flight) can still push
+// the queue past it, by a bounded amount.
+const size_t MAX_QUEUED_REPLY_BYTES = 1 << 20;
+
+volatile sig_atomic_t stopRequested = 0;
+
+void onSignal(int) { stopRequested = 1; }
+
+// Function to mix a counter into a well-spread 64-bit value (splitmix64)
+uint64_t mixSeed(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Function to set up a board of the given variant from a move list (X moves first); returns it
+GameVariant& replay(unique_ptr<GameVariant> (&engines)[VARIANT_COUNT], int variant, const uint8_t* moves, size_t count) {
+    if (!engines[variant]) engines[variant] = createVariant(variant);
+    GameVariant& position = *engines[variant];
+    position.reset();
+    for (size_t i = 0; i < count; i++) position.play(moves[i], (i % 2 == 0) ? X_PLAYER : O_PLAYER);
+    return position;
+}
+
+class MatchServer {
+public:
+    explicit MatchServer(const ServerOptions& serverOptions)
+        : options(serverOptions), pool(make_unique<ThreadPool>(serverOptions.workers)), listenFd(-1), epollFd(-1), wakeFd(-1),
+          nextConnection(1), nextSeed(1), movesServed(0), matchesStarted(0) {}
+
+    ~MatchServer() {
+        // Workers hold pointers into the server; they stop before anything else goes away
+        pool.reset();
+        for (auto& entry : connections) ::close(entry.second->fd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        if (listenFd >= 0) ::close(listenFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    // Function to listen on the loopback port; returns false on failure
+    bool start() {
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listenFd < 0) return false;
+        int yes = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options.port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, SOMAXCONN) != 0) {
+            return false;
+        }
+        epollFd = epoll_create1(0);
+        wakeFd = eventfd(0, EFD_NONBLOCK);
+        if (epollFd < 0 || wakeFd < 0) return false;
+        watch(listenFd, LISTENER, EPOLLIN);
+        watch(wakeFd, WAKER, EPOLLIN);
+        return true;
+    }
+
+    // Function to serve until a signal asks to stop
+    void run() {
+        vector<epoll_event> events(256);
+        auto reported = chrono::steady_clock::now();
+        long long reportedMoves = 0;
+        while (!stopRequested) {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+            if (ready < 0 && errno != EINTR) break;
+            for (int i = 0; i < ready; i++) {
+                uint64_t key = events[i].data.u64;
+                if (key == LISTENER) {
+                    acceptClients();
+                } else if (key == WAKER) {
+                    applyCompletions();
+                } else {
+                    handleConnection(key, events[i].events);
+                }
+            }
+            // A line of throughput every few seconds while there is traffic
+            auto now = chrono::steady_clock::now();
+            double seconds = chrono::duration<double>(now - reported).count();
+            if (seconds >= 5) {
+                if (movesServed != reportedMoves) {
+                    cout << connections.size() << " connections | " << liveMatches() << " matches | "
+                         << static_cast<long long>((movesServed - reportedMoves) / seconds) << " AI moves/s" << endl;
+                }
+                reported = now;
+                reportedMoves = movesServed;
+            }
+        }
+        cout << "Served " << movesServed << " AI moves in " << matchesStarted << " matches" << endl;
+    }
+
+private:
+    // epoll keys below the first connection id
+    static constexpr uint64_t LISTENER = 0;
+    static constexpr uint64_t WAKER = ~0ull;
+
+    void watch(int fd, uint64_t key, uint32_t events) {
+        epoll_event event = {};
+        event.events = events;
+        event.data.u64 = key;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void acceptClients() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+            uint64_t id = nextConnection++;
+            auto connection = make_unique<Connection>();
+            connection->fd = fd;
+            connections[id] = move(connection);
+            watch(fd, id, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    void closeConnection(uint64_t id) {
+        auto found = connections.find(id);
+        if (found == connections.end()) return;
+        // Closing the socket also removes it from the epoll set; pending AI moves find no connection and are dropped
+        ::close(found->second->fd);
+        connections.erase(found);
+    }
+
+    void handleConnection(uint64_t id, uint32_t events) {
+        auto found = connections.find(id);
+        if (found == connections.end()) return;
+        Connection& connection = *found->second;
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeConnection(id);
+            return;
+        }
+        if (events & EPOLLIN) {
+            unsigned char buffer[64 * 1024];
+            // Messages are handled after every read, so the reply backlog is checked before the next one
+            while (queuedReplyBytes(connection) < MAX_QUEUED_REPLY_BYTES) {
+                ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.in.insert(connection.in.end(), buffer, buffer + received);
+                    handleInput(id, connection);
+                    if (static_cast<size_t>(received) < sizeof(buffer)) break;
+                } else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    closeConnection(id);
+                    return;
+                } else {
+                    break;
+                }
+            }
+        }
+        if (!flush(id, connection)) return;
+        if ((events & EPOLLRDHUP) && connection.in.empty()) closeConnection(id);
+    }
+
+    // Function to handle every complete message received so far
+    void handleInput(uint64_t id, Connection& connection) {
+        size_t offset = 0;
+        while (connection.in.size() - offset >= protocol::MESSAGE_BYTES) {
+            handleMessage(id, connection, protocol::decode(connection.in.data() + offset));
+            offset += protocol::MESSAGE_BYTES;
+        }
+        connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+    }
+
+    static size_t queuedReplyBytes(const Connection& connection) { return connection.out.size() - connection.outSent; }
+
+    // Function to queue a message for the client (sent by flush)
+    void send(Connection& connection, uint8_t type, uint8_t arg, uint16_t cell, uint32_t matchId) {
+        protocol::Message message;
+        message.type = type;
+        message.arg = arg;
+        message.cell = cell;
+        message.matchId = matchId;
+        size_t at = connection.out.size();
+        connection.out.resize(at + protocol::MESSAGE_BYTES);
+        protocol::encode(message, connection.out.data() + at);
+    }
+
+    // Function to write out queued replies, watching for writability if the socket is full and
+    // pausing reads while too many are queued; false if it closed
+    bool flush(uint64_t id, Connection& connection) {
+        while (connection.outSent < connection.out.size()) {
+            ssize_t sent = ::send(connection.fd, connection.out.data() + connection.outSent,
+                                  connection.out.size() - connection.outSent, MSG_NOSIGNAL);
+            if (sent > 0) {
+                connection.outSent += sent;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                closeConnection(id);
+                return false;
+            }
+        }
+        if (connection.outSent == connection.out.size()) {
+            connection.out.clear();
+            connection.outSent = 0;
+        }
+        bool wantWrites = !connection.out.empty();
+        bool pauseReads = queuedReplyBytes(connection) >= MAX_QUEUED_REPLY_BYTES;
+        if (wantWrites != connection.watchingWrites || pauseReads != connection.readsPaused) {
+            epoll_event event = {};
+            event.events = (pauseReads ? 0u : static_cast<uint32_t>(EPOLLIN)) | EPOLLRDHUP |
+                           (wantWrites ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+            event.data.u64 = id;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.watchingWrites = wantWrites;
+            connection.readsPaused = pauseReads;
+        }
+        return true;
+    }
+
+    void handleMessage(uint64_t id, Connection& connection, const protocol::Message& message) {
+        if (message.type == protocol::NEW_MATCH) {
+            auto found = connection.matches.find(message.matchId);
+            if (message.arg >= VARIANT_COUNT || message.cell < 1 || message.cell > DIFFICULTY_COUNT) {
+                send(connection, protocol::FAILED, protocol::BAD_MESSAGE, 0, message.matchId);
+            } else if (found != connection.matches.end() && found->second.status == protocol::ONGOING) {
+                send(connection, protocol::FAILED, protocol::MATCH_EXISTS, 0, message.matchId);
+            } else if (found == connection.matches.end() && connection.matches.size() >= MAX_MATCHES_PER_CONNECTION) {
+                send(connection, protocol::FAILED, protocol::TOO_MANY_MATCHES, 0, message.matchId);
+            } else {
+                ServerMatch& match = connection.matches[message.matchId];
+                match.variant = message.arg;
+                match.difficulty = static_cast<uint8_t>(message.cell);
+                match.status = protocol::ONGOING;
+                match.aiThinking = false;
+                match.epoch++;
+                match.moves.clear();
+                matchesStarted++;
+                send(connection, protocol::STARTED, protocol::ONGOING, 0, message.matchId);
+            }
+        } else if (message.type == protocol::MOVE) {
+            auto found = connection.matches.find(message.matchId);
+            if (found == connection.matches.end()) {
+                send(connection, protocol::FAILED, protocol::UNKNOWN_MATCH, message.cell, message.matchId);
+            } else {
+                playClientMove(id, connection, message.matchId, found->second, message.cell);
+            }
+        } else if (message.type == protocol::END_MATCH) {
+            // A pending AI move for it is dropped when it arrives
+            connection.matches.erase(message.matchId);
+            send(connection, protocol::ENDED, protocol::ONGOING, 0, message.matchId);
+        } else {
+            send(connection, protocol::FAILED, protocol::BAD_MESSAGE, 0, message.matchId);
+        }
+    }
+
+    // Function to apply the client's move and hand the reply to the worker pool
+    void playClientMove(uint64_t id, Connection& connection, uint32_t matchId, ServerMatch& match, int cell) {
+        if (match.status != protocol::ONGOING || match.aiThinking) {
+            send(connection, protocol::FAILED, protocol::NOT_YOUR_TURN, static_cast<uint16_t>(cell), matchId);
+            return;
+        }
+        GameVariant& position = replay(loopEngines, match.variant, match.moves.data(), match.moves.size());
+        if (cell >= position.cellCount() || !position.isEmpty(cell)) {
+            send(connection, protocol::FAILED, protocol::ILLEGAL_MOVE, static_cast<uint16_t>(cell), matchId);
+            return;
+        }
+        match.moves.push_back(static_cast<uint8_t>(cell));
+        if (position.play(cell, X_PLAYER)) {
+            match.status = protocol::X_WON;
+        } else if (position.isFull()) {
+            match.status = protocol::DRAWN;
+        }
+        if (match.status != protocol::ONGOING) {
+            send(connection, protocol::MOVED, match.status, static_cast<uint16_t>(cell), matchId);
+            return;
+        }
+
+        match.aiThinking = true;
+        uint64_t seed = mixSeed(nextSeed++);
+        int variant = match.variant;
+        int difficulty = match.difficulty;
+        uint32_t epoch = match.epoch;
+        vector<uint8_t> moves = match.moves;
+        pool->submit([this, id, matchId, epoch, variant, difficulty, seed, moves = move(moves)]() {
+            // Each worker keeps its own single-threaded engines
+            thread_local unique_ptr<GameVariant> engines[VARIANT_COUNT];
+            GameVariant& board = replay(engines, variant, moves.data(), moves.size());
+            AIMove reply = chooseAIMove(board, O_PLAYER, difficulty, options.budget,
+                                        static_cast<unsigned>(seed >> 32), static_cast<unsigned>(seed));
+            AICompletion done = {id, matchId, epoch, reply.cell, protocol::ONGOING};
+            if (reply.cell < 0 || !board.isEmpty(reply.cell)) {
+                done.cell = -1;
+            } else if (board.play(reply.cell, O_PLAYER)) {
+                done.status = protocol::O_WON;
+            } else if (board.isFull()) {
+                done.status = protocol::DRAWN;
+            }
+            complete(done);
+        });
+    }
+
+    // Function called on a worker to pass a finished AI move back to the loop
+    void complete(const AICompletion& done) {
+        bool wake;
+        {
+            lock_guard<mutex> lock(completionMutex);
+            wake = completions.empty();
+            completions.push_back(done);
+        }
+        if (wake) {
+            uint64_t one = 1;
+            ssize_t written = write(wakeFd, &one, sizeof(one));
+            (void)written;
+        }
+    }
+
+    void applyCompletions() {
+        uint64_t count;
+        ssize_t drained = read(wakeFd, &count, sizeof(count));
+        (void)drained;
+        {
+            lock_guard<mutex> lock(completionMutex);
+            swap(completions, applying);
+        }
+        vector<uint64_t> touched;
+        for (const AICompletion& done : applying) {
+            auto found = connections.find(done.connection);
+            if (found == connections.end()) continue;
+            Connection& connection = *found->second;
+            auto match = connection.matches.find(done.matchId);
+            if (match == connection.matches.end() || match->second.epoch != done.epoch || !match->second.aiThinking) continue;
+            ServerMatch& state = match->second;
+            state.aiThinking = false;
+            if (done.cell < 0) {
+                // The engine had no move; only possible on a full board, which the client move already reported
+                state.status = protocol::DRAWN;
+                send(connection, protocol::AI_MOVED, state.status, 0xFFFF, done.matchId);
+            } else {
+                state.moves.push_back(static_cast<uint8_t>(done.cell));
+                state.status = done.status;
+                send(connection, protocol::AI_MOVED, state.status, static_cast<uint16_t>(done.cell), done.matchId);
+                movesServed++;
+            }
+            touched.push_back(done.connection);
+        }
+        applying.clear();
+        sort(touched.begin(), touched.end());
+        touched.erase(unique(touched.begin(), touched.end()), touched.end());
+        for (uint64_t id : touched) {
+            auto found = connections.find(id);
+            if (found != connections.end()) flush(id, *found->second);
+        }
+    }
+
+    size_t liveMatches() const {
+        size_t live = 0;
+        for (const auto& entry : connections) live += entry.second->matches.size();
+        return live;
+    }
+
+    ServerOptions options;
+    unique_ptr<ThreadPool> pool;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+    unordered_map<uint64_t, unique_ptr<Connection>> connections;
+    uint64_t nextConnection;
+    uint64_t nextSeed;
+    unique_ptr<GameVariant> loopEngines[VARIANT_COUNT];
+    mutex completionMutex;
+    vector<AICompletion> completions;
+    vector<AICompletion> applying;
+    long long movesServed;
+    long long matchesStarted;
+};
+
+void printUsage() {
+    cerr << "usage: server [--port N] [--workers N] [--hard-nodes N] [--expert-playouts N]\n";
+}
+
+int main(int argc, char** argv) {
+    ServerOptions options;
+    // Bounded by work rather than time, as in selfplay, so moves cost the same under load
+    options.budget.hardTime = chrono::milliseconds(0);
+    options.budget.hardNodes = 20000;
+    options.budget.expertTime = chrono::milliseconds(0);
+    options.budget.expertPlayouts = 2000;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--port") options.port = static_cast<uint16_t>(atoi(value.c_str()));
+        else if (arg == "--workers") options.workers = atoi(value.c_str());
+        else if (arg == "--hard-nodes") options.budget.hardNodes = atoll(value.c_str());
+        else if (arg == "--expert-playouts") options.budget.expertPlayouts = atoll(value.c_str());
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.workers < 1 || options.budget.hardNodes <= 0 || options.budget.expertPlayouts <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    MatchServer server(options);
+    if (!server.start()) {
+        cerr << "Could not listen on 127.0.0.1:" << options.port << ": " << strerror(errno) << endl;
+        return 1;
+    }
+    cout << "Match server on 127.0.0.1:" << options.port << " with " << options.workers << " AI workers" << endl;
+    server.run();
+    return 0;
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "board.h"
+
+// Compile-time solution of 3x3 tic-tac-toe.
+//
+// Every reachable position is solved by backward induction inside a constexpr
+// function, then reduced to one canonical representative per symmetry class
+// (the 4 rotations and 4 reflections of the board). Only non-terminal canonical
+// positions are kept, so the table is a few hundred 4-byte entries and a probe
+// is a symmetry canonicalisation plus a short binary search: no search at runtime.
+
+// Result of probing the table for the side to move
+struct SolvedMove {
+    int cell;   // best move in the caller's orientation, -1 if the position is not in the table
+    int value;  // +1 win, 0 draw, -1 loss for the side to move under perfect play
+};
+
+namespace solved {
+
+constexpr int STATE_COUNT = 19683;  // 3^9 base-3 encodings, not all of them legal
+constexpr int NO_MOVE = 0xF;
+
+constexpr std::array<int, Board::CELLS + 1> POW3 = {1, 3, 9, 27, 81, 243, 729, 2187, 6561, 19683};
+
+// SYMMETRIES[s][c] is the cell that cell c moves to under symmetry s
+constexpr std::array<std::array<std::uint8_t, Board::CELLS>, 8> SYMMETRIES = {{
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},  // identity
+    {2, 5, 8, 1, 4, 7, 0, 3, 6},  // rotate 90
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},  // rotate 180
+    {6, 3, 0, 7, 4, 1, 8, 5, 2},  // rotate 270
+    {2, 1, 0, 5, 4, 3, 8, 7, 6},  // mirror columns
+    {6, 7, 8, 3, 4, 5, 0, 1, 2},  // mirror rows
+    {0, 3, 6, 1, 4, 7, 2, 5, 8},  // main diagonal
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}   // anti diagonal
+}};
+
+// Table entry: base-3 key of the canonical position, best move in the low nibble
+// and value + 1 in bits 4-5
+struct Entry {
+    std::uint16_t key;
+    std::uint8_t packed;
+};
+
+// Raw 9-bit masks keep the constexpr solver well inside the compiler's evaluation limits
+struct Position {
+    std::uint16_t x;
+    std::uint16_t o;
+};
+
+constexpr std::array<std::uint16_t, Board::LINE_COUNT> buildLines() {
+    std::array<std::uint16_t, Board::LINE_COUNT> lines{};
+    for (int i = 0; i < Board::LINE_COUNT; i++) lines[i] = static_cast<std::uint16_t>(Board::WIN_MASKS[i].word(0));
+    return lines;
+}
+
+constexpr std::array<std::uint16_t, Board::LINE_COUNT> LINES = buildLines();
+
+constexpr Position toPosition(const Board& board) {
+    return {static_cast<std::uint16_t>(board.playerMask(X_PLAYER).word(0)),
+            static_cast<std::uint16_t>(board.playerMask(O_PLAYER).word(0))};
+}
+
+constexpr Position decode(int index) {
+    Position pos = {0, 0};
+    for (int c = 0; c < Board::CELLS; c++) {
+        int digit = index % 3;
+        if (digit == X_PLAYER) pos.x |= static_cast<std::uint16_t>(1u << c);
+        if (digit == O_PLAYER) pos.o |= static_cast<std::uint16_t>(1u << c);
+        index /= 3;
+    }
+    return pos;
+}
+
+// Base-3 key of the position after applying symmetry s (s = 0 is the plain encoding)
+constexpr int encodeSymmetric(const Position& pos, int s) {
+    int index = 0;
+    for (int c = 0; c < Board::CELLS; c++) {
+        int digit = ((pos.x >> c) & 1) ? X_PLAYER : ((pos.o >> c) & 1) ? O_PLAYER : EMPTY;
+        index += POW3[SYMMETRIES[s][c]] * digit;
+    }
+    return index;
+}
+
+constexpr bool hasLine(std::uint16_t mask) {
+    for (std::uint16_t line : LINES) {
+        if ((mask & line) == line) return true;
+    }
+    return false;
+}
+
+constexpr bool isCanonical(int index) {
+    Position pos = decode(index);
+    for (int s = 1; s < 8; s++) {
+        if (encodeSymmetric(pos, s) < index) return false;
+    }
+    return true;
+}
+
+// Scores are from the side to move's point of view. A decided game scores
+// (10 - plies at the end), so faster wins and slower losses are preferred.
+struct Solution {
+    std::array<bool, STATE_COUNT> reachable{};
+    std::array<std::int8_t, STATE_COUNT> score{};
+    std::array<std::int8_t, STATE_COUNT> bestMove{};
+};
+
+constexpr Solution solveAll() {
+    Solution sol;
+    // Children always have a larger base-3 index than their parent, so one
+    // ascending pass marks reachability and one descending pass solves
+    sol.reachable[0] = true;
+    for (int index = 0; index < STATE_COUNT; index++) {
+        if (!sol.reachable[index]) continue;
+        Position pos = decode(index);
+        std::uint16_t occupied = pos.x | pos.o;
+        if (occupied == 0x1FF || hasLine(pos.x) || hasLine(pos.o)) continue;
+        int weight = (std::popcount(pos.x) > std::popcount(pos.o)) ? O_PLAYER : X_PLAYER;
+        for (int cell = 0; cell < Board::CELLS; cell++) {
+            if (!((occupied >> cell) & 1)) sol.reachable[index + weight * POW3[cell]] = true;
+        }
+    }
+    for (int index = STATE_COUNT - 1; index >= 0; index--) {
+        if (!sol.reachable[index]) continue;
+        Position pos = decode(index);
+        std::uint16_t occupied = pos.x | pos.o;
+        sol.bestMove[index] = NO_MOVE;
+        if (hasLine(pos.x) || hasLine(pos.o)) {
+            sol.score[index] = static_cast<std::int8_t>(-(Board::CELLS + 1 - std::popcount(occupied)));
+            continue;
+        }
+        if (occupied == 0x1FF) {
+            sol.score[index] = 0;
+            continue;
+        }
+        int weight = (std::popcount(pos.x) > std::popcount(pos.o)) ? O_PLAYER : X_PLAYER;
+        int best = -100;
+        for (int cell = 0; cell < Board::CELLS; cell++) {
+            if ((occupied >> cell) & 1) continue;
+            int score = -sol.score[index + weight * POW3[cell]];
+            if (score > best) {
+                best = score;
+                sol.bestMove[index] = static_cast<std::int8_t>(cell);
+            }
+        }
+        sol.score[index] = static_cast<std::int8_t>(best);
+    }
+    return sol;
+}
+
+inline constexpr Solution SOLUTION = solveAll();
+
+constexpr bool isStored(int index) {
+    return SOLUTION.reachable[index] && SOLUTION.bestMove[index] != NO_MOVE && isCanonical(index);
+}
+
+constexpr int countEntries() {
+    int count = 0;
+    for (int index = 0; index < STATE_COUNT; index++) {
+        if (isStored(index)) count++;
+    }
+    return count;
+}
+
+constexpr int ENTRY_COUNT = countEntries();
+
+constexpr std::array<Entry, ENTRY_COUNT> buildTable() {
+    std::array<Entry, ENTRY_COUNT> table{};
+    int n = 0;
+    for (int index = 0; index < STATE_COUNT; index++) {
+        if (!isStored(index)) continue;
+        int score = SOLUTION.score[index];
+        int value = (score > 0) ? 1 : (score < 0) ? -1 : 0;
+        table[n].key = static_cast<std::uint16_t>(index);
+        table[n].packed = static_cast<std::uint8_t>(SOLUTION.bestMove[index] | ((value + 1) << 4));
+        n++;
+    }
+    return table;
+}
+
+// Sorted by key, since positions are visited in ascending index order
+inline constexpr std::array<Entry, ENTRY_COUNT> TABLE = buildTable();
+
+static_assert(ENTRY_COUNT < 1000, "symmetry reduction should leave well under a thousand positions");
+static_assert(SOLUTION.score[0] == 0, "perfect play from the empty board is a draw");
+
+}  // namespace solved
+
+// Function to look up the perfect-play move for the side to move
+constexpr SolvedMove probeSolvedTable(const Board& board) {
+    // Canonicalise: pick the symmetry giving the smallest key
+    solved::Position pos = solved::toPosition(board);
+    int bestSymmetry = 0;
+    int key = solved::encodeSymmetric(pos, 0);
+    for (int s = 1; s < 8; s++) {
+        int candidate = solved::encodeSymmetric(pos, s);
+        if (candidate < key) {
+            key = candidate;
+            bestSymmetry = s;
+        }
+    }
+    int low = 0;
+    int high = solved::ENTRY_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        const solved::Entry& entry = solved::TABLE[mid];
+        if (entry.key < key) {
+            low = mid + 1;
+        } else if (entry.key > key) {
+            high = mid - 1;
+        } else {
+            int canonicalCell = entry.packed & 0xF;
+            int value = ((entry.packed >> 4) & 0x3) - 1;
+            // Map the canonical move back through the inverse symmetry
+            for (int c = 0; c < Board::CELLS; c++) {
+                if (solved::SYMMETRIES[bestSymmetry][c] == canonicalCell) return {c, value};
+            }
+        }
+    }
+    return {-1, 0};
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Sound effects with no work on the frame beyond starting a voice.
+//
+// Every effect is synthesized once at startup into an sf::SoundBuffer. Voices are sf::Sound
+// objects from a fixed pool, each bound to one effect's buffer when the engine starts:
+// rebinding a voice to another buffer registers it in that buffer's set of users, which
+// allocates, so playing never does. When all of an effect's voices are busy the one that
+// started longest ago is stolen. Playing an effect only touches the voice's pitch, volume
+// and play state, none of which allocate.
+
+enum SoundEffect {
+    SOUND_MOVE,
+    SOUND_WIN,
+    SOUND_DRAW,
+    SOUND_CLICK,
+    SOUND_COUNT
+};
+
+class SoundEngine {
+public:
+    static constexpr unsigned SAMPLE_RATE = 44100;
+    static constexpr int MAX_VOICES_PER_EFFECT = 4;
+    // Voices per effect: moves and clicks can overlap quickly, game-end jingles rarely
+    static constexpr int VOICES[SOUND_COUNT] = {4, 2, 2, 3};
+
+    SoundEngine() : ready(false), muted(false), serial(0) {}
+    SoundEngine(const SoundEngine&) = delete;
+    SoundEngine& operator=(const SoundEngine&) = delete;
+
+    // Function to synthesize every effect and bind the voices; returns false if audio is unavailable
+    bool initialize() {
+        ready = false;
+        for (int effect = 0; effect < SOUND_COUNT; effect++) {
+            std::vector<std::int16_t> samples = synthesize(static_cast<SoundEffect>(effect));
+            if (!buffers[effect].loadFromSamples(samples.data(), samples.size(), 1, SAMPLE_RATE)) return false;
+            for (int v = 0; v < VOICES[effect]; v++) {
+                voices[effect][v].setBuffer(buffers[effect]);
+                startedAt[effect][v] = 0;
+            }
+        }
+        ready = true;
+        return true;
+    }
+    bool isReady() const { return ready; }
+    void setMuted(bool mute) { muted = mute; }
+    bool isMuted() const { return muted; }
+
+    // Function to start an effect on a free voice of its pool, or on the oldest one
+    void play(SoundEffect effect, float pitch = 1.0f, float volume = 100.0f) {
+        if (!ready || muted) return;
+        int victim = 0;
+        for (int v = 0; v < VOICES[effect]; v++) {
+            if (voices[effect][v].getStatus() != sf::SoundSource::Playing) {
+                victim = v;
+                break;
+            }
+            if (startedAt[effect][v] < startedAt[effect][victim]) victim = v;
+        }
+        sf::Sound& voice = voices[effect][victim];
+        voice.stop();
+        voice.setPitch(pitch);
+        voice.setVolume(volume);
+        voice.play();
+        startedAt[effect][victim] = ++serial;
+    }
+
+private:
+    // Function to add a tone with a fast attack and exponential decay to a sample buffer
+    static void addTone(std::vector<float>& mix, float frequency, float startSeconds, float seconds, float amplitude) {
+        const float TWO_PI = 6.2831853f;
+        std::size_t first = static_cast<std::size_t>(startSeconds * SAMPLE_RATE);
+        std::size_t count = static_cast<std::size_t>(seconds * SAMPLE_RATE);
+        if (mix.size() < first + count) mix.resize(first + count, 0.0f);
+        for (std::size_t i = 0; i < count; i++) {
+            float t = static_cast<float>(i) / SAMPLE_RATE;
+            float envelope = std::min(1.0f, t * 400.0f) * std::exp(-t * 6.0f / seconds);
+            mix[first + i] += amplitude * envelope * std::sin(TWO_PI * frequency * t);
+        }
+    }
+
+    // Function to generate the samples of one effect (mono, 16-bit)
+    static std::vector<std::int16_t> synthesize(SoundEffect effect) {
+        std::vector<float> mix;
+        switch (effect) {
+            case SOUND_MOVE:
+                addTone(mix, 660.0f, 0.0f, 0.07f, 0.5f);
+                addTone(mix, 1320.0f, 0.0f, 0.04f, 0.15f);
+                break;
+            case SOUND_WIN: {
+                // Rising C major arpeggio
+                const float notes[] = {523.25f, 659.25f, 783.99f, 1046.5f};
+                for (int i = 0; i < 4; i++) addTone(mix, notes[i], i * 0.09f, i == 3 ? 0.35f : 0.12f, 0.35f);
+                break;
+            }
+            case SOUND_DRAW:
+                addTone(mix, 440.0f, 0.0f, 0.15f, 0.4f);
+                addTone(mix, 330.0f, 0.14f, 0.25f, 0.4f);
+                break;
+            default:
+                addTone(mix, 1800.0f, 0.0f, 0.02f, 0.3f);
+                break;
+        }
+        std::vector<std::int16_t> samples(mix.size());
+        for (std::size_t i = 0; i < mix.size(); i++) {
+            float clamped = std::max(-1.0f, std::min(1.0f, mix[i]));
+            samples[i] = static_cast<std::int16_t>(clamped * 32767.0f);
+        }
+        return samples;
+    }
+
+    // Buffers are declared before the voices so the voices are destroyed first
+    sf::SoundBuffer buffers[SOUND_COUNT];
+    sf::Sound voices[SOUND_COUNT][MAX_VOICES_PER_EFFECT];
+    std::uint64_t startedAt[SOUND_COUNT][MAX_VOICES_PER_EFFECT];
+    bool ready;
+    bool muted;
+    std::uint64_t serial;
+};
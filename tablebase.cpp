@@ -0,0 +1,155 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+
+#include "tablebase.h"
+#include "thread_pool.h"
+#include "variant.h"
+#include "xoshiro.h"
+
+using namespace std;
+
+// Generates an endgame tablebase (see tablebase.h) and reports how long it took, how big it
+// is and how fast it answers. The game loads tablebase_NxN.bin for the board being played.
+//
+//   tablebase [--board 3x3|4x4] [--max-empty N] [--threads N] [--output FILE] [--probes N]
+//
+// --max-empty limits the table to positions with at most N empty cells (default: all of them).
+
+// Probe results are folded in here so the optimizer cannot drop the timed lookups
+volatile long long probeSink = 0;
+
+struct TablebaseOptions {
+    int variantIndex = 1;
+    int maxEmpty = 64;
+    int threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    string outputPath;
+    long long probes = 1000000;
+};
+
+// Function to parse the board name (-1 when invalid)
+int parseVariant(const string& text) {
+    for (int i = 0; i < VARIANT_COUNT; i++) {
+        if (text == VARIANTS[i].name) return i;
+    }
+    return -1;
+}
+
+void printUsage() {
+    cerr << "usage: tablebase [--board 3x3|4x4] [--max-empty N] [--threads N] [--output FILE] [--probes N]\n";
+}
+
+// Function to read the command line; returns false on a bad argument
+bool parseOptions(int argc, char** argv, TablebaseOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        string value = argv[++i];
+        if (arg == "--board") options.variantIndex = parseVariant(value);
+        else if (arg == "--max-empty") options.maxEmpty = atoi(value.c_str());
+        else if (arg == "--threads") options.threads = atoi(value.c_str());
+        else if (arg == "--output") options.outputPath = value;
+        else if (arg == "--probes") options.probes = atoll(value.c_str());
+        else return false;
+    }
+    if (options.variantIndex >= 0 && options.outputPath.empty()) {
+        options.outputPath = string("tablebase_") + VARIANTS[options.variantIndex].name + ".bin";
+    }
+    return options.variantIndex >= 0 && options.maxEmpty >= 0 && options.threads > 0 && options.probes > 0;
+}
+
+// Random positions the table covers, reached by random play and still in progress
+vector<pair<uint64_t, uint64_t>> samplePositions(const TablebaseLayout& layout, size_t count) {
+    vector<pair<uint64_t, uint64_t>> positions;
+    Xoshiro256 random(1);
+    int cells = layout.cellCount();
+    while (positions.size() < count) {
+        uint64_t x = 0;
+        uint64_t o = 0;
+        int pieces = 0;
+        int target = layout.minPieces() + static_cast<int>(random.nextBelow(static_cast<uint32_t>(layout.maxEmpty())));
+        while (pieces < target && !layout.hasLine(x) && !layout.hasLine(o)) {
+            int cell = static_cast<int>(random.nextBelow(static_cast<uint32_t>(cells)));
+            uint64_t bit = uint64_t(1) << cell;
+            if ((x | o) & bit) continue;
+            if (pieces % 2 == 0) x |= bit;
+            else o |= bit;
+            pieces++;
+        }
+        if (pieces == target && !layout.hasLine(x) && !layout.hasLine(o)) positions.push_back({x, o});
+    }
+    return positions;
+}
+
+int main(int argc, char** argv) {
+    TablebaseOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    const VariantInfo& variant = VARIANTS[options.variantIndex];
+    TablebaseLayout layout(variant.size, variant.winLength, options.maxEmpty);
+    if (!layout.feasible()) {
+        cerr << "A " << variant.name << " tablebase of positions with up to " << layout.maxEmpty()
+             << " empty cells has too many positions; try a smaller --max-empty" << endl;
+        return 1;
+    }
+    cout << "Tablebase: " << variant.name << ", up to " << layout.maxEmpty() << " empty cells, "
+         << layout.entryCount() << " positions, " << options.threads << " threads" << endl;
+
+    // The calling thread helps while it waits, so the pool needs one worker fewer
+    ThreadPool pool(options.threads - 1);
+    TablebaseBuilder builder(layout);
+    auto start = chrono::steady_clock::now();
+    builder.solve(pool);
+    double solveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    long long bytes = builder.write(options.outputPath);
+    if (bytes < 0) {
+        cerr << "Could not write " << options.outputPath << endl;
+        return 1;
+    }
+    cout.setf(ios::fixed);
+    cout.precision(1);
+    cout << "Solved in " << solveMs << " ms (" << layout.entryCount() / max(solveMs, 1e-3) / 1000 << "M positions/s)" << endl;
+    cout << "Wrote " << options.outputPath << ": " << bytes << " bytes, " << layout.entryBits() << " bits per position" << endl;
+
+    Tablebase table;
+    if (!table.open(options.outputPath)) {
+        cerr << "Could not map " << options.outputPath << " back" << endl;
+        return 1;
+    }
+    if (layout.maxEmpty() == layout.cellCount()) {
+        TablebaseValue value = TB_DRAW;
+        int distance = 0;
+        table.lookup(0, 0, value, distance);
+        cout << "Empty board: " << (value == TB_WIN ? "first player wins" : value == TB_LOSS ? "second player wins" : "draw");
+        if (value != TB_DRAW) cout << " in " << distance << " plies";
+        cout << endl;
+    }
+
+    // Probe latency over random positions, cycled so the timing is not dominated by generating them
+    vector<pair<uint64_t, uint64_t>> positions = samplePositions(layout, 4096);
+    long long sink = 0;
+    start = chrono::steady_clock::now();
+    for (long long i = 0; i < options.probes; i++) {
+        const auto& [x, o] = positions[i & 4095];
+        TablebaseValue value;
+        int distance;
+        if (table.lookup(x, o, value, distance)) sink += value + distance;
+    }
+    double lookupNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / options.probes;
+    start = chrono::steady_clock::now();
+    for (long long i = 0; i < options.probes; i++) {
+        const auto& [x, o] = positions[i & 4095];
+        sink += table.probe(x, o).cell;
+    }
+    double moveNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / options.probes;
+    probeSink = sink;
+    cout << "Probe: " << lookupNs << " ns per position, " << moveNs << " ns per best move" << endl;
+    return 0;
+}
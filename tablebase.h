@@ -0,0 +1,425 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "thread_pool.h"
+#include "variant.h"
+
+// Endgame tablebases: the perfect-play result of every position with at most a given number
+// of empty cells, solved backward from the finished games (retrograde analysis).
+//
+// A position with m pieces has ceil(m/2) X's and floor(m/2) O's, so the positions of one
+// layer are exactly the ways to choose the m occupied cells and then which of them are X.
+// Ranking both choices in the combinatorial number system gives a perfect hash with no gaps:
+//
+//   index = layerStart[m] + rank(occupied) * C(m, ceil(m/2)) + rank(X among the occupied)
+//
+// where rank() is a subset's colex rank (the order of the bit masks as integers). Positions
+// that cannot arise in play (both sides with a line, say) get an index too, which costs a
+// little space and saves any lookup structure. Every game ends within the board's cell
+// count, so the layers form a DAG: each is solved from the one with a piece more, fullest
+// first, and the positions of a layer are split across threads.
+//
+// An entry is the result for the side to move (win, draw or loss) in 2 bits, then how many
+// plies the game lasts under perfect play (shortest win, longest loss; 0 for a draw), in just
+// enough bits for the deepest layer. Entries are packed back to back after a 48-byte header
+// and the file is mapped read-only (POSIX mmap), so opening one is free and a probe touches
+// only the bytes it reads. Only boards of up to 64 cells are supported, and only 4x4 and
+// smaller have tablebases of a practical size (see TablebaseLayout::MAX_ENTRIES).
+
+enum TablebaseValue : std::uint8_t {
+    TB_DRAW,
+    TB_WIN,
+    TB_LOSS
+};
+
+// Move chosen from a tablebase, and what it leads to for the side playing it
+struct TablebaseMove {
+    int cell = -1;                     // -1 when the position is not in the table
+    TablebaseValue value = TB_DRAW;
+    int distance = 0;                  // plies until the game ends, this move included (0 for a draw)
+};
+
+namespace tablebase_index {
+
+constexpr int MAX_CELLS = 64;
+
+// Binomial coefficients C(n, k) for n, k <= 64
+constexpr std::array<std::array<std::uint64_t, MAX_CELLS + 1>, MAX_CELLS + 1> buildBinomials() {
+    std::array<std::array<std::uint64_t, MAX_CELLS + 1>, MAX_CELLS + 1> c{};
+    for (int n = 0; n <= MAX_CELLS; n++) {
+        c[n][0] = 1;
+        for (int k = 1; k <= n; k++) c[n][k] = c[n - 1][k - 1] + (k <= n - 1 ? c[n - 1][k] : 0);
+    }
+    return c;
+}
+inline constexpr auto BINOMIAL = buildBinomials();
+
+// Function to get the k-element set of a colex rank: sets of one size ranked in increasing
+// order of their masks, the rank of {c1 < c2 < ... < ck} being C(c1, 1) + C(c2, 2) + ... + C(ck, k)
+inline std::uint64_t unrankSet(std::uint64_t rank, int k) {
+    std::uint64_t set = 0;
+    for (int i = k; i >= 1; i--) {
+        int bit = i - 1;
+        while (BINOMIAL[bit + 1][i] <= rank) bit++;
+        rank -= BINOMIAL[bit][i];
+        set |= std::uint64_t(1) << bit;
+    }
+    return set;
+}
+// Function to get the next larger set of the same size (Gosper's hack)
+inline std::uint64_t nextSet(std::uint64_t set) {
+    std::uint64_t lowest = set & (~set + 1);
+    std::uint64_t ripple = set + lowest;
+    return ripple | (((set ^ ripple) >> 2) / lowest);
+}
+// Function to spread the low bits of value over the set bits of mask, lowest first
+inline std::uint64_t deposit(std::uint64_t value, std::uint64_t mask) {
+    std::uint64_t result = 0;
+    for (; mask && value; mask &= mask - 1, value >>= 1) {
+        if (value & 1) result |= mask & (~mask + 1);
+    }
+    return result;
+}
+
+}  // namespace tablebase_index
+
+// Which positions of a board a tablebase covers, and where each one is stored
+class TablebaseLayout {
+public:
+    // More entries than this would not fit in memory while generating
+    static constexpr std::uint64_t MAX_ENTRIES = std::uint64_t(1) << 33;
+
+    TablebaseLayout(int boardSize, int winLength, int maxEmpty)
+        : n(boardSize), k(winLength), cells(boardSize * boardSize), empties(std::min(maxEmpty, boardSize * boardSize)) {
+        std::uint64_t total = 0;
+        bool overflow = cells > tablebase_index::MAX_CELLS;
+        for (int m = 0; m <= tablebase_index::MAX_CELLS; m++) {
+            layerStart[m] = total;
+            if (m < minPieces() || m > cells || overflow) continue;
+            std::uint64_t occupied = tablebase_index::BINOMIAL[cells][m];
+            std::uint64_t colours = tablebase_index::BINOMIAL[m][xPieces(m)];
+            // Anything near 2^64 is far past MAX_ENTRIES anyway
+            if (occupied > MAX_ENTRIES || colours > MAX_ENTRIES || occupied * colours > MAX_ENTRIES - total) overflow = true;
+            else total += occupied * colours;
+        }
+        entries = overflow ? MAX_ENTRIES + 1 : total;
+        for (int row = 0; row < n && cells <= tablebase_index::MAX_CELLS; row++) {
+            for (int col = 0; col < n; col++) {
+                const int directions[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+                for (const auto& d : directions) {
+                    int endRow = row + d[0] * (k - 1);
+                    int endCol = col + d[1] * (k - 1);
+                    if (endRow >= n || endCol < 0 || endCol >= n) continue;
+                    std::uint64_t line = 0;
+                    for (int i = 0; i < k; i++) line |= std::uint64_t(1) << ((row + d[0] * i) * n + col + d[1] * i);
+                    lines.push_back(line);
+                }
+            }
+        }
+    }
+
+    int size() const { return n; }
+    int winLength() const { return k; }
+    int cellCount() const { return cells; }
+    int maxEmpty() const { return empties; }
+    int minPieces() const { return cells - empties; }
+    std::uint64_t entryCount() const { return entries; }
+    bool feasible() const { return entries <= MAX_ENTRIES; }
+    // Bits of distance needed for the longest game in the table, and of a whole entry
+    int distanceBits() const { return std::bit_width(static_cast<unsigned>(empties)); }
+    int entryBits() const { return 2 + distanceBits(); }
+    static int xPieces(int pieces) { return (pieces + 1) / 2; }
+    std::uint64_t firstIndex(int pieces) const { return layerStart[pieces]; }
+
+    // Function to find a position's index; returns false if the table does not cover it
+    bool index(std::uint64_t x, std::uint64_t o, std::uint64_t& result) const {
+        std::uint64_t occupied = x | o;
+        int pieces = std::popcount(occupied);
+        if ((x & o) || pieces < minPieces() || std::popcount(x) != xPieces(pieces)) return false;
+        // Both ranks in one pass: the k-th occupied cell adds to the occupied rank, and if it
+        // is an X, which X it is among the first k occupied cells adds to the X rank
+        std::uint64_t occupiedRank = 0;
+        std::uint64_t xRank = 0;
+        int seen = 0;
+        int xSeen = 0;
+        for (std::uint64_t rest = occupied; rest; rest &= rest - 1) {
+            int cell = std::countr_zero(rest);
+            occupiedRank += tablebase_index::BINOMIAL[cell][++seen];
+            if ((x >> cell) & 1) xRank += tablebase_index::BINOMIAL[seen - 1][++xSeen];
+        }
+        result = layerStart[pieces] + occupiedRank * tablebase_index::BINOMIAL[pieces][xPieces(pieces)] + xRank;
+        return true;
+    }
+    // Function to check a player's pieces for a complete line
+    bool hasLine(std::uint64_t pieces) const {
+        for (std::uint64_t line : lines) {
+            if ((pieces & line) == line) return true;
+        }
+        return false;
+    }
+
+private:
+    int n;
+    int k;
+    int cells;
+    int empties;
+    std::uint64_t entries;
+    std::uint64_t layerStart[tablebase_index::MAX_CELLS + 1];
+    std::vector<std::uint64_t> lines;
+};
+
+namespace tablebase_format {
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t boardSize;
+    std::uint32_t winLength;
+    std::uint32_t maxEmpty;
+    std::uint32_t entryBits;
+    std::uint32_t reserved;
+    std::uint64_t entryCount;
+    std::uint64_t dataBytes;
+};
+static_assert(sizeof(Header) == 48, "the tablebase header is 48 bytes on disk");
+
+constexpr char MAGIC[8] = {'T', 'T', 'T', 'B', 'A', 'S', 'E', '1'};
+constexpr std::uint32_t VERSION = 1;
+// The data is padded so an entry can always be read with one unaligned 8-byte load
+constexpr std::size_t PADDING = 8;
+
+// Unpacked entry: value in bits 0-1, distance above
+inline std::uint8_t pack(TablebaseValue value, int distance) { return static_cast<std::uint8_t>(distance << 2 | value); }
+
+}  // namespace tablebase_format
+
+// A tablebase file mapped for probing
+class Tablebase {
+public:
+    Tablebase() : map(nullptr), mappedBytes(0), data(nullptr), bits(0), layout(0, 0, 0) {}
+    ~Tablebase() { close(); }
+    Tablebase(const Tablebase&) = delete;
+    Tablebase& operator=(const Tablebase&) = delete;
+
+    // Function to map a tablebase file; returns false if it is missing or not a tablebase
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && static_cast<std::size_t>(info.st_size) >= sizeof(tablebase_format::Header);
+        if (ok) {
+            void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (address != MAP_FAILED) {
+                map = address;
+                mappedBytes = info.st_size;
+            }
+        }
+        ::close(fd);
+        if (!map) return false;
+        const tablebase_format::Header* header = static_cast<const tablebase_format::Header*>(map);
+        TablebaseLayout fileLayout(static_cast<int>(header->boardSize), static_cast<int>(header->winLength),
+                                   static_cast<int>(header->maxEmpty));
+        if (std::memcmp(header->magic, tablebase_format::MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != tablebase_format::VERSION || header->boardSize * header->boardSize > tablebase_index::MAX_CELLS ||
+            !fileLayout.feasible() || header->entryCount != fileLayout.entryCount() ||
+            header->entryBits != static_cast<std::uint32_t>(fileLayout.entryBits()) ||
+            header->dataBytes < (header->entryCount * header->entryBits + 7) / 8 + tablebase_format::PADDING ||
+            sizeof(tablebase_format::Header) + header->dataBytes > mappedBytes) {
+            close();
+            return false;
+        }
+        layout = fileLayout;
+        bits = header->entryBits;
+        data = static_cast<const unsigned char*>(map) + sizeof(tablebase_format::Header);
+        return true;
+    }
+    void close() {
+        if (map) munmap(map, mappedBytes);
+        map = nullptr;
+        mappedBytes = 0;
+        data = nullptr;
+    }
+    bool isOpen() const { return map != nullptr; }
+    std::size_t fileBytes() const { return mappedBytes; }
+    const TablebaseLayout& positions() const { return layout; }
+
+    // Function to look a position up; returns false if the table does not cover it
+    bool lookup(std::uint64_t x, std::uint64_t o, TablebaseValue& value, int& distance) const {
+        std::uint64_t index;
+        if (!map || !layout.index(x, o, index)) return false;
+        std::uint64_t bit = index * bits;
+        std::uint64_t word;
+        std::memcpy(&word, data + (bit >> 3), sizeof(word));
+        unsigned entry = static_cast<unsigned>(word >> (bit & 7)) & ((1u << bits) - 1);
+        value = static_cast<TablebaseValue>(entry & 3);
+        distance = static_cast<int>(entry >> 2);
+        return true;
+    }
+
+    // Function to pick the perfect-play move of a game in progress: the fastest win, else a
+    // draw, else the slowest loss. Returns cell -1 if the table does not cover the position.
+    TablebaseMove probe(const GameVariant& variant) const {
+        if (!map || variant.size() != layout.size() || variant.winLength() != layout.winLength()) return TablebaseMove();
+        std::uint64_t x = 0;
+        std::uint64_t o = 0;
+        for (int cell = 0; cell < variant.cellCount(); cell++) {
+            CellState state = variant.at(cell);
+            if (state == X_PLAYER) x |= std::uint64_t(1) << cell;
+            else if (state == O_PLAYER) o |= std::uint64_t(1) << cell;
+        }
+        return probe(x, o);
+    }
+    TablebaseMove probe(std::uint64_t x, std::uint64_t o) const {
+        TablebaseMove best;
+        std::uint64_t occupied = x | o;
+        if (!map || std::popcount(occupied) < layout.minPieces() || layout.hasLine(x) || layout.hasLine(o)) return best;
+        bool xToMove = std::popcount(x) == std::popcount(o);
+        std::uint64_t board = (layout.cellCount() == 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << layout.cellCount()) - 1;
+        int bestRank = -1;
+        for (std::uint64_t free = board & ~occupied; free; free &= free - 1) {
+            std::uint64_t piece = free & (~free + 1);
+            TablebaseValue reply;
+            int distance;
+            if (!lookup(x | (xToMove ? piece : 0), o | (xToMove ? 0 : piece), reply, distance)) return TablebaseMove();
+            // The entry is the opponent's: their loss is our win, one ply further away
+            TablebaseValue value = (reply == TB_LOSS) ? TB_WIN : (reply == TB_WIN) ? TB_LOSS : TB_DRAW;
+            int rank = (value == TB_WIN) ? 3 * 128 - distance : (value == TB_DRAW) ? 2 * 128 : distance;
+            if (rank > bestRank) {
+                bestRank = rank;
+                best.cell = std::countr_zero(piece);
+                best.value = value;
+                best.distance = (value == TB_DRAW) ? 0 : distance + 1;
+            }
+        }
+        return best;
+    }
+
+private:
+    void* map;
+    std::size_t mappedBytes;
+    const unsigned char* data;
+    unsigned bits;
+    TablebaseLayout layout;
+};
+
+// Solves the positions of a layout and writes them out as a tablebase
+class TablebaseBuilder {
+public:
+    // Occupied-cell sets solved per task; small enough to spread a layer over any core count
+    static constexpr std::uint64_t TASK_SETS = 256;
+
+    explicit TablebaseBuilder(const TablebaseLayout& positions) : layout(positions) {}
+
+    // Function to solve every covered position, fullest layer first; returns false if the layout is too big
+    bool solve(ThreadPool& pool) {
+        if (!layout.feasible()) return false;
+        entries.assign(layout.entryCount(), 0);
+        for (int pieces = layout.cellCount(); pieces >= layout.minPieces(); pieces--) {
+            std::uint64_t sets = tablebase_index::BINOMIAL[layout.cellCount()][pieces];
+            TaskGroup group(pool);
+            for (std::uint64_t first = 0; first < sets; first += TASK_SETS) {
+                std::uint64_t last = std::min(sets, first + TASK_SETS);
+                group.run([this, pieces, first, last]() { solveSets(pieces, first, last); });
+            }
+            group.wait();
+        }
+        return true;
+    }
+
+    // Result of a solved position by index (value in bits 0-1, distance above)
+    std::uint8_t entry(std::uint64_t index) const { return entries[index]; }
+
+    // Function to pack the entries and write the file; returns the bytes written or -1
+    long long write(const std::string& path) const {
+        int bits = layout.entryBits();
+        std::size_t packedBytes = (entries.size() * bits + 7) / 8 + tablebase_format::PADDING;
+        std::vector<unsigned char> packed(packedBytes, 0);
+        std::uint64_t bit = 0;
+        for (std::uint8_t value : entries) {
+            for (int b = 0; b < bits; b++, bit++) {
+                if ((value >> b) & 1) packed[bit >> 3] |= static_cast<unsigned char>(1u << (bit & 7));
+            }
+        }
+        tablebase_format::Header header = {};
+        std::memcpy(header.magic, tablebase_format::MAGIC, sizeof(header.magic));
+        header.version = tablebase_format::VERSION;
+        header.boardSize = layout.size();
+        header.winLength = layout.winLength();
+        header.maxEmpty = layout.maxEmpty();
+        header.entryBits = bits;
+        header.entryCount = entries.size();
+        header.dataBytes = packed.size();
+
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return -1;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  std::fwrite(packed.data(), 1, packed.size(), file) == packed.size();
+        ok = std::fclose(file) == 0 && ok;
+        return ok ? static_cast<long long>(sizeof(header) + packed.size()) : -1;
+    }
+
+private:
+    // Function to solve the positions whose occupied cells have ranks [first, last) in their layer
+    void solveSets(int pieces, std::uint64_t first, std::uint64_t last) {
+        int xCount = TablebaseLayout::xPieces(pieces);
+        std::uint64_t colourings = tablebase_index::BINOMIAL[pieces][xCount];
+        std::uint64_t occupied = tablebase_index::unrankSet(first, pieces);
+        for (std::uint64_t rank = first; rank < last; rank++) {
+            std::uint64_t index = layout.firstIndex(pieces) + rank * colourings;
+            std::uint64_t which = (std::uint64_t(1) << xCount) - 1;
+            for (std::uint64_t c = 0; c < colourings; c++) {
+                std::uint64_t x = tablebase_index::deposit(which, occupied);
+                entries[index + c] = solvePosition(x, occupied & ~x, pieces);
+                if (xCount > 0) which = tablebase_index::nextSet(which);
+            }
+            if (pieces > 0) occupied = tablebase_index::nextSet(occupied);
+        }
+    }
+    // Function to solve one position from its children, which are already solved
+    std::uint8_t solvePosition(std::uint64_t x, std::uint64_t o, int pieces) const {
+        // A line means the side that just moved has won
+        if (layout.hasLine(x) || layout.hasLine(o)) return tablebase_format::pack(TB_LOSS, 0);
+        if (pieces == layout.cellCount()) return tablebase_format::pack(TB_DRAW, 0);
+        bool xToMove = (pieces % 2 == 0);
+        std::uint64_t occupied = x | o;
+        std::uint64_t board = (layout.cellCount() == 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << layout.cellCount()) - 1;
+        int fastestWin = -1;
+        int slowestLoss = -1;
+        bool draw = false;
+        for (std::uint64_t free = board & ~occupied; free; free &= free - 1) {
+            std::uint64_t piece = free & (~free + 1);
+            std::uint64_t child = 0;
+            layout.index(x | (xToMove ? piece : 0), o | (xToMove ? 0 : piece), child);
+            std::uint8_t reply = entries[child];
+            int distance = (reply >> 2) + 1;
+            if ((reply & 3) == TB_LOSS) {
+                if (fastestWin == -1 || distance < fastestWin) fastestWin = distance;
+            } else if ((reply & 3) == TB_DRAW) {
+                draw = true;
+            } else {
+                slowestLoss = std::max(slowestLoss, distance);
+            }
+        }
+        if (fastestWin != -1) return tablebase_format::pack(TB_WIN, fastestWin);
+        if (draw) return tablebase_format::pack(TB_DRAW, 0);
+        return tablebase_format::pack(TB_LOSS, slowestLoss);
+    }
+
+    TablebaseLayout layout;
+    std::vector<std::uint8_t> entries;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its
+// own tasks at the back (newest first, good locality for recursive splits) and,
+// when it runs dry, steals the oldest task from the front of another deque.
+// Threads outside the pool submit through an extra shared queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount) : queued(0), stopping(false) {
+        if (threadCount < 0) threadCount = 0;
+        for (int i = 0; i <= threadCount; i++) queues.push_back(std::make_unique<Queue>());
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+    ~ThreadPool() {
+        stopping = true;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of worker threads (the thread waiting on a TaskGroup helps as well)
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // Function to queue a task; workers push onto their own deque
+    void submit(std::function<void()> task) {
+        Queue& queue = *queues[callerQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        queued++;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_one();
+    }
+
+    // Function to run one queued task on the calling thread; returns false if there was none
+    bool runPendingTask() {
+        std::function<void()> task;
+        if (!takeTask(callerQueue(), task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    int callerQueue() const {
+        return (currentPool == this) ? currentWorker : static_cast<int>(queues.size()) - 1;
+    }
+
+    bool takeTask(int own, std::function<void()>& task) {
+        if (queued.load(std::memory_order_relaxed) == 0) return false;
+        // Own queue first, newest task
+        {
+            Queue& queue = *queues[own];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        // Then steal the oldest task from the others
+        int count = static_cast<int>(queues.size());
+        for (int offset = 1; offset < count; offset++) {
+            Queue& victim = *queues[(own + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int index) {
+        currentPool = this;
+        currentWorker = index;
+        while (!stopping) {
+            if (runPendingTask()) continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> queued;
+    std::atomic<bool> stopping;
+
+    inline static thread_local const ThreadPool* currentPool = nullptr;
+    inline static thread_local int currentWorker = -1;
+};
+
+// A set of tasks that can be waited on. The waiting thread keeps running queued
+// tasks instead of blocking, so nested groups never starve the pool.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& p) : pool(p), pending(0) {}
+    ~TaskGroup() { wait(); }
+
+    void run(std::function<void()> task) {
+        pending++;
+        pool.submit([this, task = std::move(task)]() {
+            task();
+            pending--;
+        });
+    }
+
+    void wait() {
+        while (pending.load() > 0) {
+            if (!pool.runPendingTask()) std::this_thread::yield();
+        }
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> pending;
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Transposition table shared by every thread of a search.
+//
+// The table is a power-of-two array of 64-byte buckets (one cache line), each holding four
+// 16-byte entries. An entry is two 64-bit words written without locks: the packed data and
+// the position key XORed with that data. A reader accepts an entry only if the two words
+// XOR back to its key, so a torn write from another thread, or a different position that
+// maps to the same bucket, reads as a miss instead of as wrong data.
+//
+//   data bits 0-31   score (relative to the node; see scoreToTable in search.h)
+//             32-47  best move (0xFFFF for none)
+//             48-55  depth searched
+//             56-57  bound
+//             58-63  generation of the search that stored it
+
+enum TTBound : std::uint8_t {
+    TT_NONE,
+    TT_EXACT,
+    TT_LOWER,   // score is at least this (the search failed high)
+    TT_UPPER    // score is at most this (the search failed low)
+};
+
+struct TTEntry {
+    int score = 0;
+    int move = -1;
+    int depth = 0;
+    TTBound bound = TT_NONE;
+};
+
+// Probe and store counts; searches keep their own and fold them into the table when done
+struct TTCounters {
+    long long probes = 0;
+    long long hits = 0;
+    long long stores = 0;
+    long long collisions = 0;   // stores that evicted another position stored by the same search
+
+    void add(const TTCounters& other) {
+        probes += other.probes;
+        hits += other.hits;
+        stores += other.stores;
+        collisions += other.collisions;
+    }
+    // Function to get the counts since an earlier snapshot of the same totals
+    TTCounters since(const TTCounters& earlier) const {
+        TTCounters delta;
+        delta.probes = probes - earlier.probes;
+        delta.hits = hits - earlier.hits;
+        delta.stores = stores - earlier.stores;
+        delta.collisions = collisions - earlier.collisions;
+        return delta;
+    }
+    double hitRate() const { return probes > 0 ? static_cast<double>(hits) / probes : 0; }
+    double collisionRate() const { return stores > 0 ? static_cast<double>(collisions) / stores : 0; }
+};
+
+class TranspositionTable {
+public:
+    static constexpr int BUCKET_ENTRIES = 4;
+    static constexpr int MAX_GENERATION = 63;
+
+    // bucketCount is rounded down to a power of two
+    explicit TranspositionTable(std::size_t bucketCount) : generation(0) {
+        std::size_t count = 1;
+        while (count * 2 <= bucketCount) count *= 2;
+        buckets = std::make_unique<Bucket[]>(count);
+        mask = count - 1;
+        clear();
+    }
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Function to forget every entry and the statistics (not while a search is running)
+    void clear() {
+        for (std::size_t b = 0; b <= mask; b++) {
+            for (Slot& slot : buckets[b].slots) {
+                slot.check.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
+        probes = 0;
+        hits = 0;
+        stores = 0;
+        collisions = 0;
+        generation = 0;
+    }
+    // Function to start a new search: older entries become the first to be replaced
+    void newSearch() { generation = (generation + 1) & MAX_GENERATION; }
+
+    // Function to look a position up; returns true and fills entry on a hit
+    bool probe(std::uint64_t key, TTEntry& entry, TTCounters& counters) const {
+        counters.probes++;
+        const Bucket& bucket = buckets[key & mask];
+        for (const Slot& slot : bucket.slots) {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+            if ((check ^ data) != key || boundOf(data) == TT_NONE) continue;
+            entry.score = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+            std::uint16_t move = static_cast<std::uint16_t>(data >> 32);
+            entry.move = (move == NO_MOVE) ? -1 : move;
+            entry.depth = static_cast<int>((data >> 48) & 0xFF);
+            entry.bound = boundOf(data);
+            counters.hits++;
+            return true;
+        }
+        return false;
+    }
+
+    // Function to store a search result. The same position is always overwritten; otherwise
+    // the victim is an empty entry, then one from an earlier search, then the shallowest.
+    void store(std::uint64_t key, const TTEntry& entry, TTCounters& counters) {
+        counters.stores++;
+        Bucket& bucket = buckets[key & mask];
+        Slot* victim = nullptr;
+        int victimValue = 0;
+        bool victimLive = false;
+        int move = entry.move;
+        for (Slot& slot : bucket.slots) {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+            TTBound bound = boundOf(data);
+            if ((check ^ data) == key && bound != TT_NONE) {
+                std::uint16_t oldMove = static_cast<std::uint16_t>(data >> 32);
+                if (move == -1 && oldMove != NO_MOVE) move = oldMove;
+                victim = &slot;
+                victimLive = false;
+                break;
+            }
+            bool current = bound != TT_NONE && static_cast<int>(data >> 58) == generation;
+            int value = (bound == TT_NONE) ? -1 : static_cast<int>((data >> 48) & 0xFF) + (current ? 256 : 0);
+            if (!victim || value < victimValue) {
+                victim = &slot;
+                victimValue = value;
+                victimLive = current;
+            }
+        }
+        if (victimLive) counters.collisions++;
+
+        std::uint64_t data = static_cast<std::uint32_t>(entry.score) |
+                             static_cast<std::uint64_t>(move == -1 ? NO_MOVE : static_cast<std::uint16_t>(move)) << 32 |
+                             static_cast<std::uint64_t>(entry.depth & 0xFF) << 48 |
+                             static_cast<std::uint64_t>(entry.bound) << 56 |
+                             static_cast<std::uint64_t>(generation) << 58;
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    // Function to add a search's counts to the table's totals
+    void account(const TTCounters& counters) {
+        probes.fetch_add(counters.probes, std::memory_order_relaxed);
+        hits.fetch_add(counters.hits, std::memory_order_relaxed);
+        stores.fetch_add(counters.stores, std::memory_order_relaxed);
+        collisions.fetch_add(counters.collisions, std::memory_order_relaxed);
+    }
+    // Totals since the table was created or last cleared
+    TTCounters stats() const {
+        TTCounters totals;
+        totals.probes = probes.load(std::memory_order_relaxed);
+        totals.hits = hits.load(std::memory_order_relaxed);
+        totals.stores = stores.load(std::memory_order_relaxed);
+        totals.collisions = collisions.load(std::memory_order_relaxed);
+        return totals;
+    }
+
+    std::size_t capacity() const { return (mask + 1) * BUCKET_ENTRIES; }
+    std::size_t bytes() const { return (mask + 1) * sizeof(Bucket); }
+
+private:
+    static constexpr std::uint16_t NO_MOVE = 0xFFFF;
+
+    struct Slot {
+        std::atomic<std::uint64_t> check;
+        std::atomic<std::uint64_t> data;
+    };
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_ENTRIES];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket is one cache line");
+
+    static TTBound boundOf(std::uint64_t data) { return static_cast<TTBound>((data >> 56) & 0x3); }
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t mask;
+    int generation;
+    std::atomic<long long> probes{0};
+    std::atomic<long long> hits{0};
+    std::atomic<long long> stores{0};
+    std::atomic<long long> collisions{0};
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstddef>
+
+// The UI font, and warming its glyph atlas before the first frame.
+//
+// When embedded_font.h exists (generate it with embed_font, see the README) the font is
+// compiled into the binary and loaded from memory, so the game starts the same from any
+// working directory. Without it the game falls back to ARIAL.TTF in the working directory.
+//
+// SFML rasterizes a glyph the first time it is drawn at a given size and style, which shows
+// as a hitch on the first visit to each screen. prewarmGlyphs() renders every glyph the UI
+// can draw up front; it may run on another thread as long as nothing else touches the font
+// until it returns.
+#if __has_include("embedded_font.h")
+#include "embedded_font.h"
+#define TTT_EMBEDDED_FONT 1
+#endif
+
+// Function to load the UI font; returns false if there is none
+inline bool loadUIFont(sf::Font& font) {
+#ifdef TTT_EMBEDDED_FONT
+    return font.loadFromMemory(EMBEDDED_FONT, EMBEDDED_FONT_SIZE);
+#else
+    return font.loadFromFile("ARIAL.TTF");
+#endif
+}
+
+// One character size and style the UI draws text at, and the characters it needs there
+struct GlyphSet {
+    const sf::Font* font;
+    unsigned size;
+    bool bold;
+    const char* characters;
+};
+
+// Every printable ASCII character: labels, statistics and the overlay are all plain ASCII
+constexpr const char* UI_CHARACTERS =
+    " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+
+// Function to rasterize the glyphs of every set into their fonts' atlases; returns the time taken in ms
+inline double prewarmGlyphs(const GlyphSet* sets, std::size_t count) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; i++) {
+        for (const char* c = sets[i].characters; *c; c++) {
+            sets[i].font->getGlyph(static_cast<unsigned char>(*c), sets[i].size, sets[i].bold);
+        }
+        // Line spacing and the atlas texture are looked up per size as well
+        sets[i].font->getLineSpacing(sets[i].size);
+        sets[i].font->getTexture(sets[i].size);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "board.h"
+#include "line_tracker.h"
+#include "mcts.h"
+#include "parallel_search.h"
+#include "search.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+
+// Board sizes the game ships with: N x N board, K in a row wins
+struct VariantInfo {
+    int size;
+    int winLength;
+    const char* name;
+};
+
+constexpr VariantInfo VARIANTS[] = {
+    {3, 3, "3x3"},
+    {4, 4, "4x4"},
+    {7, 5, "7x7"},
+    {15, 5, "15x15"}
+};
+constexpr int VARIANT_COUNT = sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+
+// Rules and AI for one board size, behind a virtual interface so the UI can switch size at runtime
+class GameVariant {
+public:
+    virtual ~GameVariant() {}
+
+    virtual int size() const = 0;
+    virtual int winLength() const = 0;
+    int cellCount() const { return size() * size(); }
+
+    virtual CellState at(int cell) const = 0;
+    virtual bool isEmpty(int cell) const = 0;
+    // Function to place a piece; returns true when the move completes a line
+    virtual bool play(int cell, CellState player) = 0;
+    virtual bool isFull() const = 0;
+    virtual void reset() = 0;
+    // Zobrist key of the current position (see zobrist.h)
+    virtual std::uint64_t positionKey() const = 0;
+    // True when the search answers every position perfectly from the compile-time solved table
+    virtual bool hasSolvedTable() const = 0;
+
+    // Function to pick an empty cell from a caller-supplied random value
+    virtual int randomMove(unsigned randomValue) const = 0;
+    // Function to find a cell that wins for the player, or else blocks the opponent's win (-1 if neither)
+    virtual int strategicMove(CellState player) const = 0;
+    // Function to run the alpha-beta engine for the side to move
+    virtual SearchResult searchMove(const SearchLimits& limits) = 0;
+    virtual void clearSearchHistory() = 0;
+    // Function to search on a shared thread pool from now on (nullptr goes back to one thread)
+    virtual void setThreadPool(ThreadPool* pool) = 0;
+    virtual int searchThreads() const = 0;
+    // Function to run Monte Carlo Tree Search for the side to move
+    virtual MCTSResult mctsMove(const MCTSLimits& limits) = 0;
+};
+
+template <int N, int K>
+class Variant : public GameVariant {
+public:
+    using BoardType = BasicBoard<N, K>;
+    using Mask = typename BoardType::Mask;
+
+    int size() const override { return N; }
+    int winLength() const override { return K; }
+
+    CellState at(int cell) const override { return lines.position().at(cell); }
+    bool isEmpty(int cell) const override { return lines.position().isEmpty(cell); }
+    bool play(int cell, CellState player) override { return lines.make(cell, player); }
+    bool isFull() const override { return lines.position().isFull(); }
+    void reset() override { lines.reset(); }
+    std::uint64_t positionKey() const override { return lines.key(); }
+    bool hasSolvedTable() const override { return N == 3 && K == 3; }
+
+    int randomMove(unsigned randomValue) const override {
+        int availableMoves[BoardType::CELLS];
+        int count = 0;
+        Mask moves = lines.position().emptyMask();
+
+        while (moves.any()) {
+            availableMoves[count++] = moves.popLowest();
+        }
+
+        if (count == 0) return -1;
+        return availableMoves[randomValue % count];
+    }
+
+    int strategicMove(CellState player) const override {
+        int cell = lines.completingCell(player);
+        if (cell == -1) {
+            cell = lines.completingCell(opponentOf(player));
+        }
+        return cell;
+    }
+
+    SearchResult searchMove(const SearchLimits& limits) override {
+        // The table is only allocated by variants that actually search
+        if (!table) {
+            table = std::make_unique<TranspositionTable>(TABLE_BUCKETS);
+            engine.setTable(table.get());
+            if (parallelEngine) parallelEngine->setTable(table.get());
+        }
+        if (parallelEngine) return parallelEngine->search(lines.position(), limits);
+        return engine.search(lines.position(), limits);
+    }
+    void clearSearchHistory() override {
+        engine.clearHistory();
+        if (parallelEngine) parallelEngine->clearHistory();
+        if (table) table->clear();
+    }
+    void setThreadPool(ThreadPool* pool) override {
+        if (pool) {
+            parallelEngine = std::make_unique<ParallelSearch<BoardType>>(*pool);
+            parallelEngine->setTable(table.get());
+        } else {
+            parallelEngine.reset();
+        }
+        mcts.setThreadPool(pool);
+    }
+    int searchThreads() const override { return parallelEngine ? parallelEngine->threadCount() : 1; }
+    MCTSResult mctsMove(const MCTSLimits& limits) override { return mcts.search(lines.position(), limits); }
+
+    const BoardType& position() const { return lines.position(); }
+
+private:
+    // 64-byte buckets of four entries: 4 KiB for 3x3 (mostly answered by the solved table),
+    // 1 MiB for 4x4 and 7x7, 4 MiB for 15x15
+    static constexpr std::size_t TABLE_BUCKETS = (N <= 3) ? (1 << 6) : (N <= 7) ? (1 << 14) : (1 << 16);
+
+    // Board with per-line piece counts, so wins and threats never need a scan of every line
+    LineTracker<N, K> lines;
+    AlphaBetaSearch<BoardType> engine;
+    std::unique_ptr<ParallelSearch<BoardType>> parallelEngine;
+    // Shared by both engines; kept across the moves of a game and cleared between games
+    std::unique_ptr<TranspositionTable> table;
+    MCTSSearch<BoardType> mcts;
+};
+
+// Function to create the rules and AI for one of the shipped variants
+inline std::unique_ptr<GameVariant> createVariant(int index) {
+    switch (index) {
+        case 1: return std::make_unique<Variant<4, 4>>();
+        case 2: return std::make_unique<Variant<7, 5>>();
+        case 3: return std::make_unique<Variant<15, 5>>();
+        default: return std::make_unique<Variant<3, 3>>();
+    }
+}
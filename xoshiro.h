@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+// Seeded pseudo-random numbers for the simulation (xoshiro256**).
+//
+// Every subsystem that needs random numbers owns its own generator, seeded from the session
+// seed and a stream number, so one subsystem drawing more or fewer numbers never shifts what
+// another one sees. Together with the fixed simulation step this makes a session a pure
+// function of its seed and its input, which is what lets a recording replay exactly.
+class Xoshiro256 {
+public:
+    explicit Xoshiro256(std::uint64_t seed = 0, std::uint64_t stream = 0) { reseed(seed, stream); }
+
+    // Function to restart the sequence of a seed and stream; the state is filled by splitmix64
+    void reseed(std::uint64_t seed, std::uint64_t stream = 0) {
+        std::uint64_t value = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (std::uint64_t& word : state) {
+            value += 0x9E3779B97F4A7C15ull;
+            std::uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // Function to draw the next 64 random bits
+    std::uint64_t next() {
+        std::uint64_t result = rotate(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate(state[3], 45);
+        return result;
+    }
+    // Function to draw a value in [0, bound) without modulo bias worth measuring (multiply-shift)
+    std::uint32_t nextBelow(std::uint32_t bound) {
+        return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32);
+    }
+    // Function to draw a float in [0, 1)
+    float nextFloat() { return static_cast<float>(next() >> 40) * (1.0f / 16777216.0f); }
+
+    // Function to fold the state into one word, for checking that two runs stayed in step
+    std::uint64_t fingerprint() const { return state[0] ^ rotate(state[1], 16) ^ rotate(state[2], 32) ^ rotate(state[3], 48); }
+
+private:
+    static std::uint64_t rotate(std::uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+    std::uint64_t state[4];
+};
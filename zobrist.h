@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "board.h"
+
+// Zobrist position keys: a fixed random 64-bit key per (board size, cell, piece), XORed
+// together over the occupied cells on top of a key for the empty board. Placing or
+// removing a piece is a single XOR, so a key can follow a position move by move.
+// The values are part of the opening book file format; do not change them.
+namespace zobrist {
+
+// Function to spread a value over 64 bits (splitmix64 finalizer)
+constexpr std::uint64_t mix(std::uint64_t value) {
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+// Key of the empty board of a size
+constexpr std::uint64_t root(int boardSize) { return mix(0x424F4F4Bull << 8 | static_cast<std::uint64_t>(boardSize)); }
+// Key XORed in when a piece is placed on a cell
+constexpr std::uint64_t piece(int boardSize, int cell, CellState player) {
+    return mix(static_cast<std::uint64_t>(boardSize) << 40 | static_cast<std::uint64_t>(cell) << 2 | player);
+}
+
+// Precomputed piece keys of one board size, indexed [cell * 2 + player - 1]
+template <int N>
+constexpr std::array<std::uint64_t, 2 * N * N> buildPieceKeys() {
+    std::array<std::uint64_t, 2 * N * N> keys{};
+    for (int cell = 0; cell < N * N; cell++) {
+        keys[cell * 2] = piece(N, cell, X_PLAYER);
+        keys[cell * 2 + 1] = piece(N, cell, O_PLAYER);
+    }
+    return keys;
+}
+
+template <int N>
+struct Keys {
+    static constexpr std::uint64_t ROOT = root(N);
+    static constexpr std::array<std::uint64_t, 2 * N * N> PIECES = buildPieceKeys<N>();
+
+    static constexpr std::uint64_t pieceKey(int cell, CellState player) { return PIECES[cell * 2 + player - 1]; }
+};
+
+}  // namespace zobrist